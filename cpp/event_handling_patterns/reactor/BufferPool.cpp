@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <new>
+
+#include "BufferPool.h"
+
+BufferPool::BufferPool(std::size_t bufferSize) :
+    bufferSize_{ bufferSize == 0 ? kDefaultBufferSize : bufferSize },
+    mutex_{},
+    free_{ nullptr },
+    available_{ 0 },
+    slabs_{}
+{
+    // Empty
+}
+
+BufferPool::~BufferPool()
+{
+    for (SharedBuffer::Slab* slab : slabs_)
+    {
+        slab->~Slab();
+        ::operator delete(slab, std::align_val_t{ kCacheLineSize });
+    }
+}
+
+SharedBuffer BufferPool::acquire()
+{
+    SharedBuffer::Slab* slab{ nullptr };
+    {
+        const std::lock_guard<std::mutex> lock{ mutex_ };
+        if (free_ != nullptr)
+        {
+            slab = free_;
+            free_ = slab->next_;
+            --available_;
+        }
+        else
+        {
+            // Reserve the room for the new buffer, so that it's never lost to an exception.
+            // The room grows geometrically, so that warming the pool up doesn't copy the slabs over and over
+            if (slabs_.size() == slabs_.capacity())
+            {
+                constexpr std::size_t kMinSlabs{ 16 };
+                slabs_.reserve(std::max(kMinSlabs, 2 * slabs_.capacity()));
+            }
+            void* memory{ ::operator new(kHeaderSize + bufferSize_, std::align_val_t{ kCacheLineSize }) };
+            slab = new (memory) SharedBuffer::Slab{ {}, this, nullptr };
+            slabs_.push_back(slab);
+        }
+    }
+
+    slab->references_.store(1, std::memory_order_relaxed);
+    slab->next_ = nullptr;
+    return SharedBuffer{ slab, reinterpret_cast<char*>(slab) + kHeaderSize, bufferSize_ };
+}
+
+std::size_t BufferPool::buffer_size() const noexcept
+{
+    return bufferSize_;
+}
+
+std::size_t BufferPool::allocated() const
+{
+    const std::lock_guard<std::mutex> lock{ mutex_ };
+    return slabs_.size();
+}
+
+std::size_t BufferPool::available() const
+{
+    const std::lock_guard<std::mutex> lock{ mutex_ };
+    return available_;
+}
+
+void BufferPool::recycle(SharedBuffer::Slab* slab) noexcept
+{
+    const std::lock_guard<std::mutex> lock{ mutex_ };
+    slab->next_ = free_;
+    free_ = slab;
+    ++available_;
+}
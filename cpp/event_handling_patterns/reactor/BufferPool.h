@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <span>
+#include <vector>
+
+class BufferPool;
+
+// A reference counted view of a pooled buffer. Copies and slices share the memory instead of copying it,
+// and the last one gone returns the buffer to its pool, so data travels from a read to handlers
+// and back to writes without a single copy or allocation
+class SharedBuffer
+{
+public:
+
+    SharedBuffer() noexcept = default;
+    SharedBuffer(const SharedBuffer& other) noexcept;
+    SharedBuffer(SharedBuffer&& other) noexcept;
+    SharedBuffer& operator=(const SharedBuffer& other) noexcept;
+    SharedBuffer& operator=(SharedBuffer&& other) noexcept;
+    ~SharedBuffer();
+
+    char* data() const noexcept;
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+    std::span<char> bytes() const noexcept;
+
+    // A view of a part of this one, which is clamped to its bounds
+    SharedBuffer slice(std::size_t offset, std::size_t size) const noexcept;
+
+    // Whether nobody else refers to the buffer, so it may be overwritten
+    bool unique() const noexcept;
+
+    explicit operator bool() const noexcept;
+
+private:
+    friend class BufferPool;
+
+    // A header of a buffer, which is followed by its memory starting at the next cache line
+    struct Slab
+    {
+        std::atomic<std::size_t> references_;
+        BufferPool* pool_;
+        Slab* next_;
+    };
+
+    SharedBuffer(Slab* slab, char* data, std::size_t size) noexcept;
+
+    void release() noexcept;
+
+    Slab* slab_{ nullptr };
+    char* data_{ nullptr };
+    std::size_t size_{ 0 };
+
+};
+
+// Buffers of a fixed size, aligned to cache lines, which are recycled instead of being freed.
+// The pool grows on demand and keeps its buffers until it is gone, so a steady flow of traffic
+// doesn't touch the allocator. A pool serves a single event loop, so its lock is rarely contended,
+// though buffers are free to be released on any thread. It is to outlive all of its buffers
+class BufferPool
+{
+public:
+
+    static constexpr std::size_t kCacheLineSize{ 64 };
+    static constexpr std::size_t kDefaultBufferSize{ 4096 };
+
+    BufferPool(const BufferPool& other) = delete;
+    BufferPool(BufferPool&& other) = delete;
+    BufferPool& operator=(const BufferPool& other) = delete;
+    BufferPool& operator=(BufferPool&& other) = delete;
+
+    explicit BufferPool(std::size_t bufferSize = kDefaultBufferSize);
+    ~BufferPool();
+
+    // A buffer of the whole size
+    SharedBuffer acquire();
+
+    std::size_t buffer_size() const noexcept;
+    // Buffers ever allocated and the ones waiting to be reused
+    std::size_t allocated() const;
+    std::size_t available() const;
+
+private:
+    friend class SharedBuffer;
+
+    static constexpr std::size_t kHeaderSize{ kCacheLineSize };
+    static_assert(sizeof(SharedBuffer::Slab) <= kHeaderSize, "Expecting a header to fit a cache line");
+
+    void recycle(SharedBuffer::Slab* slab) noexcept;
+
+    const std::size_t bufferSize_;
+    mutable std::mutex mutex_;
+    SharedBuffer::Slab* free_;
+    std::size_t available_;
+    std::vector<SharedBuffer::Slab*> slabs_;
+
+};
+
+inline SharedBuffer::SharedBuffer(Slab* slab, char* data, std::size_t size) noexcept :
+    slab_{ slab },
+    data_{ data },
+    size_{ size }
+{
+    // Empty
+}
+
+inline SharedBuffer::SharedBuffer(const SharedBuffer& other) noexcept :
+    slab_{ other.slab_ },
+    data_{ other.data_ },
+    size_{ other.size_ }
+{
+    if (slab_ != nullptr)
+    {
+        slab_->references_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+inline SharedBuffer::SharedBuffer(SharedBuffer&& other) noexcept :
+    slab_{ other.slab_ },
+    data_{ other.data_ },
+    size_{ other.size_ }
+{
+    other.slab_ = nullptr;
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+inline SharedBuffer& SharedBuffer::operator=(const SharedBuffer& other) noexcept
+{
+    if (this != &other)
+    {
+        SharedBuffer copy{ other };
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+inline SharedBuffer& SharedBuffer::operator=(SharedBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        slab_ = other.slab_;
+        data_ = other.data_;
+        size_ = other.size_;
+        other.slab_ = nullptr;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+inline SharedBuffer::~SharedBuffer()
+{
+    release();
+}
+
+inline char* SharedBuffer::data() const noexcept
+{
+    return data_;
+}
+
+inline std::size_t SharedBuffer::size() const noexcept
+{
+    return size_;
+}
+
+inline bool SharedBuffer::empty() const noexcept
+{
+    return size_ == 0;
+}
+
+inline std::span<char> SharedBuffer::bytes() const noexcept
+{
+    return std::span<char>{ data_, size_ };
+}
+
+inline SharedBuffer SharedBuffer::slice(std::size_t offset, std::size_t size) const noexcept
+{
+    const std::size_t start{ offset < size_ ? offset : size_ };
+    const std::size_t length{ size < size_ - start ? size : size_ - start };
+    SharedBuffer view{ *this };
+    view.data_ += start;
+    view.size_ = length;
+    return view;
+}
+
+inline bool SharedBuffer::unique() const noexcept
+{
+    return slab_ != nullptr && slab_->references_.load(std::memory_order_acquire) == 1;
+}
+
+inline SharedBuffer::operator bool() const noexcept
+{
+    return slab_ != nullptr;
+}
+
+inline void SharedBuffer::release() noexcept
+{
+    if (slab_ != nullptr && slab_->references_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        slab_->pool_->recycle(slab_);
+    }
+    slab_ = nullptr;
+}
@@ -0,0 +1,235 @@
+#include <utility>
+#include <variant>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/write.hpp>
+
+#include "Connection.h"
+
+static boost::asio::const_buffer as_buffer(const Connection::Segment& segment) noexcept
+{
+    if (const SharedBuffer* shared{ std::get_if<SharedBuffer>(&segment) })
+    {
+        return boost::asio::const_buffer{ shared->data(), shared->size() };
+    }
+    return boost::asio::buffer(std::get<std::string>(segment));
+}
+
+Connection::Connection(EventLoop& loop, boost::asio::ip::tcp::socket socket) :
+    loop_{ loop },
+    socket_{ std::move(socket) },
+    reading_{},
+    pending_{},
+    writing_{},
+    gather_{},
+    idle_{},
+    idleTimeout_{ EventLoop::Clock::duration::zero() },
+    onRead_{},
+    onClose_{},
+    closed_{ false }
+{
+    // Latency matters more than packet count for request-response traffic
+    boost::system::error_code ignored{};
+    socket_.set_option(boost::asio::ip::tcp::no_delay{ true }, ignored);
+}
+
+void Connection::on_read(ReadHandler handler)
+{
+    onRead_ = std::move(handler);
+}
+
+void Connection::on_close(CloseHandler handler)
+{
+    onClose_ = std::move(handler);
+}
+
+void Connection::start()
+{
+    if (!loop_.running_in_loop())
+    {
+        loop_.post([self = shared_from_this()]() { self->start(); });
+        return;
+    }
+
+    read();
+}
+
+void Connection::idle_timeout(EventLoop::Clock::duration timeout)
+{
+    if (!loop_.running_in_loop())
+    {
+        loop_.post([self = shared_from_this(), timeout]() { self->idle_timeout(timeout); });
+        return;
+    }
+
+    idleTimeout_ = timeout;
+    if (closed_ || timeout <= EventLoop::Clock::duration::zero())
+    {
+        loop_.wheel().cancel(idle_);
+        return;
+    }
+    loop_.wheel().schedule(idle_, timeout, [this]() { expire(); });
+}
+
+void Connection::write(Segment segment)
+{
+    if (!loop_.running_in_loop())
+    {
+        loop_.post([self = shared_from_this(), segment = std::move(segment)]() mutable { self->write(std::move(segment)); });
+        return;
+    }
+
+    if (closed_)
+    {
+        return;
+    }
+
+    enqueue(segment);
+    // A single write is in flight at a time, the rest wait for it
+    if (writing_.empty() && !pending_.empty())
+    {
+        flush();
+    }
+}
+
+void Connection::write(std::vector<Segment> segments)
+{
+    if (!loop_.running_in_loop())
+    {
+        loop_.post([self = shared_from_this(), segments = std::move(segments)]() mutable { self->write(std::move(segments)); });
+        return;
+    }
+
+    if (closed_)
+    {
+        return;
+    }
+
+    for (Segment& segment : segments)
+    {
+        enqueue(segment);
+    }
+    if (writing_.empty() && !pending_.empty())
+    {
+        flush();
+    }
+}
+
+void Connection::close()
+{
+    if (!loop_.running_in_loop())
+    {
+        loop_.post([self = shared_from_this()]() { self->close(); });
+        return;
+    }
+
+    shut(boost::system::error_code{});
+}
+
+EventLoop& Connection::loop() noexcept
+{
+    return loop_;
+}
+
+boost::asio::ip::tcp::endpoint Connection::remote_endpoint() const
+{
+    boost::system::error_code ignored{};
+    return socket_.remote_endpoint(ignored);
+}
+
+void Connection::read()
+{
+    // The last buffer is read into again, unless a handler has kept it
+    if (!reading_.unique())
+    {
+        reading_ = loop_.buffers().acquire();
+    }
+
+    loop_.stats().armed();
+    socket_.async_read_some(boost::asio::mutable_buffer{ reading_.data(), reading_.size() },
+        [self = shared_from_this()](const boost::system::error_code& error, const std::size_t size)
+    {
+        const LoopStats::Dispatch dispatch{ self->loop_.stats(), HandlerKind::Read };
+        if (error)
+        {
+            self->shut(error);
+            return;
+        }
+
+        self->loop_.wheel().rearm(self->idle_, self->idleTimeout_);
+        if (self->onRead_)
+        {
+            self->onRead_(*self, self->reading_.slice(0, size));
+        }
+        if (!self->closed_)
+        {
+            self->read();
+        }
+    });
+}
+
+void Connection::expire()
+{
+    // Closing may release the last reference to the connection
+    const std::shared_ptr<Connection> self{ shared_from_this() };
+    shut(boost::asio::error::timed_out);
+}
+
+void Connection::enqueue(Segment& segment)
+{
+    if (as_buffer(segment).size() != 0)
+    {
+        pending_.push_back(std::move(segment));
+    }
+}
+
+void Connection::flush()
+{
+    // Segments being written stay in place till the write is over, as their buffers point into them
+    writing_.swap(pending_);
+    gather_.clear();
+    for (const Segment& segment : writing_)
+    {
+        gather_.push_back(as_buffer(segment));
+    }
+
+    loop_.stats().armed();
+    boost::asio::async_write(socket_, gather_,
+        [self = shared_from_this()](const boost::system::error_code& error, const std::size_t)
+    {
+        const LoopStats::Dispatch dispatch{ self->loop_.stats(), HandlerKind::Write };
+        if (error)
+        {
+            self->shut(error);
+            return;
+        }
+
+        self->writing_.clear();
+        if (!self->pending_.empty())
+        {
+            self->flush();
+        }
+    });
+}
+
+void Connection::shut(const boost::system::error_code& error)
+{
+    if (closed_)
+    {
+        return;
+    }
+
+    closed_ = true;
+    loop_.wheel().cancel(idle_);
+    boost::system::error_code ignored{};
+    socket_.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored);
+    socket_.close(ignored);
+
+    // A peer closing the connection in an orderly way is not an error
+    const boost::system::error_code reason{ error == boost::asio::error::eof ? boost::system::error_code{} : error };
+    if (onClose_)
+    {
+        onClose_(*this, reason);
+    }
+}
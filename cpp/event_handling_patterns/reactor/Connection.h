@@ -0,0 +1,85 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/system/error_code.hpp>
+
+#include "BufferPool.h"
+#include "EventLoop.h"
+#include "TimerWheel.h"
+
+// A TCP connection bound to a single event loop. Its handlers are run by the loop thread one at a time,
+// so they touch the connection without strands or locks. Writes are accepted from any thread,
+// and go out in the order of calls from a single thread.
+//
+// Data is read into buffers of the pool of the loop and handed over to handlers as is. Handlers may keep
+// or write the buffers back without copying them, and a write of several segments is gathered by a single call,
+// so a header and a body are never concatenated. Whatever is written while a write is in flight
+// goes out with the next one.
+//
+// Handlers are to be registered before the connection starts reading, which the reactor does
+// right after an accept handler returns. A connection keeps itself alive while it's got pending operations
+class Connection : public std::enable_shared_from_this<Connection>
+{
+public:
+    // A handler keeping a copy of the data makes the connection read into another buffer
+    using ReadHandler = std::function<void(Connection& connection, const SharedBuffer& data)>;
+    // The error is the one, which has broken the connection, or an empty one after a local closure
+    using CloseHandler = std::function<void(Connection& connection, const boost::system::error_code& error)>;
+
+    // A piece of data to write, which is either shared or owned by the connection
+    using Segment = std::variant<SharedBuffer, std::string>;
+
+    Connection(const Connection& other) = delete;
+    Connection(Connection&& other) = delete;
+    Connection& operator=(const Connection& other) = delete;
+    Connection& operator=(Connection&& other) = delete;
+
+    Connection(EventLoop& loop, boost::asio::ip::tcp::socket socket);
+
+    void on_read(ReadHandler handler);
+    void on_close(CloseHandler handler);
+
+    void start();
+
+    // Closing the connection with timed_out once nothing has been read for a while, or never for a zero one.
+    // Every read rearms the timeout at the wheel of the loop, which costs next to nothing
+    void idle_timeout(EventLoop::Clock::duration timeout);
+
+    void write(Segment segment);
+    // Writing segments back to back, as if they were a single piece of data
+    void write(std::vector<Segment> segments);
+    // Closing a connection drops unsent data
+    void close();
+
+    EventLoop& loop() noexcept;
+    boost::asio::ip::tcp::endpoint remote_endpoint() const;
+
+private:
+
+    void read();
+    void expire();
+    void enqueue(Segment& segment);
+    void flush();
+    void shut(const boost::system::error_code& error);
+
+    EventLoop& loop_;
+    boost::asio::ip::tcp::socket socket_;
+    SharedBuffer reading_;
+    // Segments waiting for the write in flight, the ones being written and their buffers
+    std::vector<Segment> pending_;
+    std::vector<Segment> writing_;
+    std::vector<boost::asio::const_buffer> gather_;
+    WheelTimer idle_;
+    EventLoop::Clock::duration idleTimeout_;
+    ReadHandler onRead_;
+    CloseHandler onClose_;
+    bool closed_;
+
+};
@@ -0,0 +1,147 @@
+#include <iostream>
+#include <utility>
+
+#include <boost/asio/post.hpp>
+
+#include "EventLoop.h"
+
+#include "ThreadPlacement.h"
+
+EventLoop::EventLoop(std::optional<unsigned> cpu) :
+    buffers_{},
+    stats_{},
+    wheel_{},
+    // A context is run by a single thread, which lets Asio pick its single-threaded scheduler.
+    // Locking stays on nevertheless, since handlers are posted and data are written from other threads,
+    // so the hint is never to be turned into BOOST_ASIO_CONCURRENCY_HINT_UNSAFE
+    context_{ 1 },
+    work_{ boost::asio::make_work_guard(context_) },
+    tick_{ std::make_shared<boost::asio::steady_timer>(context_, TimerWheel::kDefaultResolution) },
+    cpu_{ cpu },
+    thread_{}
+{
+    // Handlers of the wheel are accounted as timeouts rather than as a single timer
+    repeat(tick_, TimerWheel::kDefaultResolution, HandlerKind::Timeout, [this]() { wheel_->advance(Clock::now()); });
+}
+
+EventLoop::~EventLoop()
+{
+    stop();
+    join();
+}
+
+void EventLoop::start()
+{
+    stats_.started();
+    thread_ = std::thread{ [this]()
+    {
+        // The thread is pinned before it runs a handler or touches the memory of the loop,
+        // which is then mapped on the node of its processor
+        if (cpu_ && !ThreadPlacement::pin_current_thread(*cpu_))
+        {
+            std::cerr << "Fail to pin an event loop to CPU " << *cpu_ << ", so it floats" << std::endl;
+        }
+        wheel_ = std::make_unique<TimerWheel>();
+        context_.run();
+    } };
+}
+
+void EventLoop::stop()
+{
+    work_.reset();
+    context_.stop();
+}
+
+void EventLoop::join()
+{
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+boost::asio::io_context& EventLoop::context() noexcept
+{
+    return context_;
+}
+
+std::optional<unsigned> EventLoop::cpu() const noexcept
+{
+    return cpu_;
+}
+
+BufferPool& EventLoop::buffers() noexcept
+{
+    return buffers_;
+}
+
+TimerWheel& EventLoop::wheel() noexcept
+{
+    return *wheel_;
+}
+
+LoopStats& EventLoop::stats() noexcept
+{
+    return stats_;
+}
+
+bool EventLoop::running_in_loop() noexcept
+{
+    return context_.get_executor().running_in_this_thread();
+}
+
+// A timer is ready at its expiry, unless it has been cancelled
+static std::optional<EventLoop::Clock::time_point> ready(const boost::asio::steady_timer& timer, const boost::system::error_code& error)
+{
+    return error ? std::nullopt : std::optional<EventLoop::Clock::time_point>{ timer.expiry() };
+}
+
+void EventLoop::post(Handler handler)
+{
+    stats_.posted();
+    boost::asio::post(context_, [this, posted = Clock::now(), handler = std::move(handler)]()
+    {
+        const LoopStats::Dispatch dispatch{ stats_, HandlerKind::Post, posted };
+        handler();
+    });
+}
+
+EventLoop::Timer EventLoop::after(Clock::duration delay, Handler handler)
+{
+    Timer timer{ std::make_shared<boost::asio::steady_timer>(context_, delay) };
+    stats_.armed();
+    timer->async_wait([this, timer, handler = std::move(handler)](const boost::system::error_code& error)
+    {
+        const LoopStats::Dispatch dispatch{ stats_, HandlerKind::Timer, ready(*timer, error) };
+        if (!error)
+        {
+            handler();
+        }
+    });
+    return timer;
+}
+
+EventLoop::Timer EventLoop::every(Clock::duration period, Handler handler)
+{
+    Timer timer{ std::make_shared<boost::asio::steady_timer>(context_, period) };
+    repeat(timer, period, HandlerKind::Timer, std::move(handler));
+    return timer;
+}
+
+void EventLoop::repeat(const Timer& timer, Clock::duration period, HandlerKind kind, Handler handler)
+{
+    stats_.armed();
+    timer->async_wait([this, timer, period, kind, handler = std::move(handler)](const boost::system::error_code& error) mutable
+    {
+        const LoopStats::Dispatch dispatch{ stats_, kind, ready(*timer, error) };
+        if (error)
+        {
+            return;
+        }
+
+        handler();
+        // Count periods from the previous expiry rather than from now, so that handlers don't drift
+        timer->expires_at(timer->expiry() + period);
+        repeat(timer, period, kind, std::move(handler));
+    });
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <thread>
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include "BufferPool.h"
+#include "LoopStats.h"
+#include "TimerWheel.h"
+
+// A single-threaded event loop: an io_context run by a dedicated thread, which is optionally pinned to a processor.
+// Everything bound to the context of a loop is handled by its thread only, so handlers sharing a loop
+// need neither strands nor locks to touch common state
+class EventLoop
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using Handler = std::function<void()>;
+    using Timer = std::shared_ptr<boost::asio::steady_timer>;
+
+    EventLoop() = delete;
+    EventLoop(const EventLoop& other) = delete;
+    EventLoop(EventLoop&& other) = delete;
+    EventLoop& operator=(const EventLoop& other) = delete;
+    EventLoop& operator=(EventLoop&& other) = delete;
+
+    explicit EventLoop(std::optional<unsigned> cpu);
+    ~EventLoop();
+
+    // A loop keeps running without any work until it is stopped
+    void start();
+    void stop();
+    void join();
+
+    boost::asio::io_context& context() noexcept;
+    std::optional<unsigned> cpu() const noexcept;
+    // Buffers for the I/O of the loop, which stay warm in the cache of its processor
+    BufferPool& buffers() noexcept;
+    // Timeouts of the loop, which are ticked by a single timer however many of them are pending.
+    // The wheel is created by the loop thread once it's started, and is to be used on that thread only
+    TimerWheel& wheel() noexcept;
+    // Statistics of the handlers the loop has dispatched, which are safe to snapshot from any thread
+    LoopStats& stats() noexcept;
+
+    // Whether the calling thread is the one of the loop
+    bool running_in_loop() noexcept;
+
+    // Running a handler on the loop thread
+    void post(Handler handler);
+
+    // Running a handler on the loop thread once after a delay, or periodically until the timer is cancelled,
+    // which is to be done on the loop thread as well
+    Timer after(Clock::duration delay, Handler handler);
+    Timer every(Clock::duration period, Handler handler);
+
+private:
+
+    void repeat(const Timer& timer, Clock::duration period, HandlerKind kind, Handler handler);
+
+    // Pending handlers may hold buffers and timeouts, so the pool and the wheel are to outlive the context
+    BufferPool buffers_;
+    LoopStats stats_;
+    std::unique_ptr<TimerWheel> wheel_;
+    boost::asio::io_context context_;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_;
+    Timer tick_;
+    const std::optional<unsigned> cpu_;
+    std::thread thread_;
+
+};
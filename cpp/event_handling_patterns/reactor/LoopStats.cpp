@@ -0,0 +1,77 @@
+#include <bit>
+
+#include "LoopStats.h"
+
+double LoopStatsSnapshot::utilization() const noexcept
+{
+    if (uptime_ <= std::chrono::nanoseconds::zero())
+    {
+        return 0.0;
+    }
+    return static_cast<double>(busy_.count()) / static_cast<double>(uptime_.count());
+}
+
+LoopStats::LoopStats() noexcept :
+    handlers_{},
+    queueDelays_{},
+    started_{ Clock::now().time_since_epoch().count() },
+    busy_{ 0 },
+    queued_{ 0 },
+    outstanding_{ 0 }
+{
+    // Empty
+}
+
+void LoopStats::started() noexcept
+{
+    started_.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+LoopStatsSnapshot LoopStats::snapshot() const
+{
+    LoopStatsSnapshot snapshot{};
+    for (std::size_t k{ 0 }; k < kHandlerKinds; ++k)
+    {
+        const Counters& counters{ handlers_[k] };
+        HandlerStats& stats{ snapshot.handlers_[k] };
+        stats.calls_ = counters.calls_.load(std::memory_order_relaxed);
+        stats.busy_ = std::chrono::nanoseconds{ counters.busy_.load(std::memory_order_relaxed) };
+        stats.longest_ = std::chrono::nanoseconds{ counters.longest_.load(std::memory_order_relaxed) };
+        for (std::size_t b{ 0 }; b < kDurationBuckets; ++b)
+        {
+            stats.durations_[b] = counters.durations_[b].load(std::memory_order_relaxed);
+        }
+    }
+    for (std::size_t b{ 0 }; b < kDurationBuckets; ++b)
+    {
+        snapshot.queueDelays_[b] = queueDelays_[b].load(std::memory_order_relaxed);
+    }
+
+    const Clock::time_point started{ Clock::duration{ started_.load(std::memory_order_relaxed) } };
+    snapshot.uptime_ = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started);
+    snapshot.busy_ = std::chrono::nanoseconds{ busy_.load(std::memory_order_relaxed) };
+    snapshot.queued_ = queued_.load(std::memory_order_relaxed);
+    snapshot.outstanding_ = outstanding_.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+std::size_t LoopStats::bucket_of(Clock::duration duration) noexcept
+{
+    const std::size_t bucket{ static_cast<std::size_t>(std::bit_width(static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()))) };
+    return bucket < kDurationBuckets ? bucket : kDurationBuckets - 1;
+}
+
+void LoopStats::dispatched(HandlerKind kind, Clock::time_point start, Clock::time_point end) noexcept
+{
+    const std::int64_t elapsed{ std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() };
+    Counters& counters{ handlers_[static_cast<std::size_t>(kind)] };
+    bump(counters.calls_, 1);
+    bump(counters.busy_, elapsed);
+    if (elapsed > counters.longest_.load(std::memory_order_relaxed))
+    {
+        counters.longest_.store(elapsed, std::memory_order_relaxed);
+    }
+    bump(counters.durations_[bucket_of(end - start)], 1);
+    bump(busy_, elapsed);
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <optional>
+
+// Kinds of handlers an event loop dispatches
+enum class HandlerKind : std::size_t
+{
+    Post,
+    Timer,
+    // Timeouts of the wheel of a loop, which are fired by its tick
+    Timeout,
+    Accept,
+    Read,
+    Write
+};
+
+inline constexpr std::size_t kHandlerKinds{ 6 };
+// A bucket i counts durations within [2^(i-1), 2^i) nanoseconds, the last one counts everything longer
+inline constexpr std::size_t kDurationBuckets{ 36 };
+
+struct HandlerStats
+{
+    std::uint64_t calls_;
+    std::chrono::nanoseconds busy_;
+    std::chrono::nanoseconds longest_;
+    std::array<std::uint64_t, kDurationBuckets> durations_;
+};
+
+struct LoopStatsSnapshot
+{
+    std::array<HandlerStats, kHandlerKinds> handlers_;
+    // Time from a handler being ready to it being started, which is known for posts and timers only
+    std::array<std::uint64_t, kDurationBuckets> queueDelays_;
+    std::chrono::nanoseconds uptime_;
+    std::chrono::nanoseconds busy_;
+    // Posted handlers waiting to be run, and every operation awaiting its handler including them
+    std::uint64_t queued_;
+    std::uint64_t outstanding_;
+
+    // Part of the uptime spent in handlers
+    double utilization() const noexcept;
+};
+
+// Statistics of handlers of an event loop. Handler counters are only written by the loop thread,
+// so they are updated with plain relaxed stores, and a snapshot, which may be taken by any thread at any time,
+// costs the loop nothing. A dispatch takes two clock readings, and a post takes one more for its queue delay
+class LoopStats
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Measuring a handler from its construction till its destruction
+    class Dispatch
+    {
+    public:
+
+        Dispatch() = delete;
+        Dispatch(const Dispatch& other) = delete;
+        Dispatch(Dispatch&& other) = delete;
+        Dispatch& operator=(const Dispatch& other) = delete;
+        Dispatch& operator=(Dispatch&& other) = delete;
+
+        Dispatch(LoopStats& stats, HandlerKind kind, std::optional<Clock::time_point> ready = std::nullopt) noexcept;
+        ~Dispatch();
+
+    private:
+
+        LoopStats& stats_;
+        const HandlerKind kind_;
+        const Clock::time_point start_;
+
+    };
+
+    LoopStats(const LoopStats& other) = delete;
+    LoopStats(LoopStats&& other) = delete;
+    LoopStats& operator=(const LoopStats& other) = delete;
+    LoopStats& operator=(LoopStats&& other) = delete;
+
+    LoopStats() noexcept;
+
+    // Counting the uptime from now on
+    void started() noexcept;
+
+    // An operation is initiated and its handler is to come, possibly from another thread for posts
+    void armed() noexcept;
+    void posted() noexcept;
+
+    LoopStatsSnapshot snapshot() const;
+
+private:
+
+    struct Counters
+    {
+        std::atomic<std::uint64_t> calls_{};
+        std::atomic<std::int64_t> busy_{};
+        std::atomic<std::int64_t> longest_{};
+        std::array<std::atomic<std::uint64_t>, kDurationBuckets> durations_{};
+    };
+
+    // Only the loop thread changes a counter of handlers, so it's got no need for a read-modify-write
+    template <typename T, typename V>
+    static void bump(std::atomic<T>& counter, V value) noexcept;
+    static std::size_t bucket_of(Clock::duration duration) noexcept;
+    void dispatched(HandlerKind kind, Clock::time_point start, Clock::time_point end) noexcept;
+
+    std::array<Counters, kHandlerKinds> handlers_;
+    std::array<std::atomic<std::uint64_t>, kDurationBuckets> queueDelays_;
+    std::atomic<Clock::rep> started_;
+    std::atomic<std::int64_t> busy_;
+    std::atomic<std::uint64_t> queued_;
+    std::atomic<std::uint64_t> outstanding_;
+
+};
+
+template <typename T, typename V>
+inline void LoopStats::bump(std::atomic<T>& counter, V value) noexcept
+{
+    counter.store(counter.load(std::memory_order_relaxed) + static_cast<T>(value), std::memory_order_relaxed);
+}
+
+inline LoopStats::Dispatch::Dispatch(LoopStats& stats, HandlerKind kind, std::optional<Clock::time_point> ready) noexcept :
+    stats_{ stats },
+    kind_{ kind },
+    start_{ Clock::now() }
+{
+    stats_.outstanding_.fetch_sub(1, std::memory_order_relaxed);
+    if (kind_ == HandlerKind::Post)
+    {
+        stats_.queued_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    if (ready)
+    {
+        bump(stats_.queueDelays_[bucket_of(start_ > *ready ? start_ - *ready : Clock::duration::zero())], 1);
+    }
+}
+
+inline LoopStats::Dispatch::~Dispatch()
+{
+    stats_.dispatched(kind_, start_, Clock::now());
+}
+
+inline void LoopStats::armed() noexcept
+{
+    outstanding_.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void LoopStats::posted() noexcept
+{
+    queued_.fetch_add(1, std::memory_order_relaxed);
+    outstanding_.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <iostream>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include <boost/asio/error.hpp>
+#include <boost/asio/socket_base.hpp>
+
+#include "Reactor.h"
+
+Reactor::Reactor(std::size_t loops, bool pinned) :
+    loops_{},
+    listeners_{},
+    next_{ 0 }
+{
+    const std::size_t count{ std::max<std::size_t>(loops, 1) };
+    for (std::size_t l{ 0 }; l < count; ++l)
+    {
+        // Extra loops share processors with the first ones
+        const unsigned processor{ static_cast<unsigned>(l % default_loop_count()) };
+        const std::optional<unsigned> cpu{ pinned ? std::optional<unsigned>{ processor } : std::nullopt };
+        loops_.push_back(std::make_unique<EventLoop>(cpu));
+    }
+}
+
+Reactor::~Reactor()
+{
+    stop();
+    join();
+}
+
+boost::asio::ip::tcp::endpoint Reactor::listen(const boost::asio::ip::tcp::endpoint& endpoint, AcceptHandler handler)
+{
+    listeners_.push_back(std::make_unique<Listener>(Listener{
+        boost::asio::ip::tcp::acceptor{ loops_.front()->context() }, std::move(handler) }));
+    Listener& listener{ *listeners_.back() };
+
+    boost::asio::ip::tcp::acceptor& acceptor{ listener.acceptor_ };
+    acceptor.open(endpoint.protocol());
+    acceptor.set_option(boost::asio::socket_base::reuse_address{ true });
+    acceptor.bind(endpoint);
+    acceptor.listen(boost::asio::socket_base::max_listen_connections);
+    accept(listener);
+    return acceptor.local_endpoint();
+}
+
+void Reactor::start()
+{
+    for (const std::unique_ptr<EventLoop>& loop : loops_)
+    {
+        loop->start();
+    }
+}
+
+void Reactor::run()
+{
+    start();
+    join();
+}
+
+void Reactor::stop()
+{
+    for (const std::unique_ptr<EventLoop>& loop : loops_)
+    {
+        loop->stop();
+    }
+}
+
+void Reactor::join()
+{
+    for (const std::unique_ptr<EventLoop>& loop : loops_)
+    {
+        loop->join();
+    }
+}
+
+std::size_t Reactor::loop_count() const noexcept
+{
+    return loops_.size();
+}
+
+EventLoop& Reactor::loop(std::size_t index)
+{
+    return *loops_.at(index);
+}
+
+EventLoop& Reactor::next_loop() noexcept
+{
+    return *loops_[next_.fetch_add(1, std::memory_order_relaxed) % loops_.size()];
+}
+
+std::size_t Reactor::default_loop_count() noexcept
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void Reactor::accept(Listener& listener)
+{
+    // A socket is accepted right into the context of its loop, so that it never migrates
+    EventLoop& target{ next_loop() };
+    loops_.front()->stats().armed();
+    listener.acceptor_.async_accept(target.context(),
+        [this, &listener, &target](const boost::system::error_code& error, boost::asio::ip::tcp::socket socket)
+    {
+        const LoopStats::Dispatch dispatch{ loops_.front()->stats(), HandlerKind::Accept };
+        if (error == boost::asio::error::operation_aborted)
+        {
+            return;
+        }
+
+        if (error)
+        {
+            // Failures like running out of descriptors persist for a while, so back off instead of spinning on them
+            std::cerr << "Fail to accept a connection due to " << error.message() << std::endl;
+            loops_.front()->after(kAcceptRetryDelay, [this, &listener]() { accept(listener); });
+            return;
+        }
+
+        std::shared_ptr<Connection> connection{ std::make_shared<Connection>(target, std::move(socket)) };
+        target.post([&listener, connection]()
+        {
+            listener.handler_(connection);
+            connection->start();
+        });
+        accept(listener);
+    });
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <boost/asio/ip/tcp.hpp>
+
+#include "Connection.h"
+#include "EventLoop.h"
+
+// A reactor of a loop per core: every event loop is run by its own thread, pinned to its own processor,
+// and accepted connections are spread across the loops round-robin, so that a connection stays
+// with a single thread for its whole life and handlers of different connections run in parallel.
+//
+// Handlers are registered per listening endpoint, per connection and per timer of a loop
+class Reactor
+{
+public:
+    // Called on the loop of a fresh connection to register its handlers, before it starts reading
+    using AcceptHandler = std::function<void(const std::shared_ptr<Connection>& connection)>;
+
+    Reactor() = delete;
+    Reactor(const Reactor& other) = delete;
+    Reactor(Reactor&& other) = delete;
+    Reactor& operator=(const Reactor& other) = delete;
+    Reactor& operator=(Reactor&& other) = delete;
+
+    // Loops are pinned to processors 0, 1 and so on, unless they are asked to float
+    explicit Reactor(std::size_t loops = default_loop_count(), bool pinned = true);
+    ~Reactor();
+
+    // Accepting connections at an endpoint, which is done by the first loop, and telling the one bound,
+    // which has got a port of its own for the zero one
+    boost::asio::ip::tcp::endpoint listen(const boost::asio::ip::tcp::endpoint& endpoint, AcceptHandler handler);
+
+    void start();
+    // Starting the loops and waiting for them to be stopped
+    void run();
+    void stop();
+    void join();
+
+    std::size_t loop_count() const noexcept;
+    EventLoop& loop(std::size_t index);
+    // A loop to hand the next piece of work over to
+    EventLoop& next_loop() noexcept;
+
+    // A loop per hardware thread
+    static std::size_t default_loop_count() noexcept;
+
+private:
+
+    struct Listener
+    {
+        boost::asio::ip::tcp::acceptor acceptor_;
+        AcceptHandler handler_;
+    };
+
+    // A pause before accepting again after a failure, which also bounds the rate of reporting them
+    static constexpr std::chrono::milliseconds kAcceptRetryDelay{ 100 };
+
+    void accept(Listener& listener);
+
+    std::vector<std::unique_ptr<EventLoop>> loops_;
+    std::vector<std::unique_ptr<Listener>> listeners_;
+    std::atomic<std::size_t> next_;
+
+};
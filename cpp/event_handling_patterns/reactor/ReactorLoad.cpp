@@ -0,0 +1,233 @@
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include "Connection.h"
+#include "Reactor.h"
+
+using Clock = std::chrono::steady_clock;
+
+// A connection sending a request and waiting for the whole of its echo before sending the next one
+class Client
+{
+public:
+
+    Client(boost::asio::io_context& context, const boost::asio::ip::tcp::endpoint& server, std::size_t size) :
+        socket_{ context },
+        request_(size, 'x'),
+        reply_(size),
+        sent_{},
+        deadline_{},
+        latencies_{}
+    {
+        socket_.connect(server);
+        socket_.set_option(boost::asio::ip::tcp::no_delay{ true });
+    }
+
+    void start(Clock::time_point deadline)
+    {
+        deadline_ = deadline;
+        send();
+    }
+
+    const std::vector<std::int64_t>& latencies() const noexcept
+    {
+        return latencies_;
+    }
+
+private:
+
+    void send()
+    {
+        sent_ = Clock::now();
+        boost::asio::async_write(socket_, boost::asio::buffer(request_),
+            [this](const boost::system::error_code& error, std::size_t)
+        {
+            if (!error)
+            {
+                receive();
+            }
+        });
+    }
+
+    void receive()
+    {
+        boost::asio::async_read(socket_, boost::asio::buffer(reply_),
+            [this](const boost::system::error_code& error, std::size_t)
+        {
+            if (error)
+            {
+                return;
+            }
+
+            const Clock::time_point now{ Clock::now() };
+            latencies_.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(now - sent_).count());
+            if (now < deadline_)
+            {
+                send();
+            }
+        });
+    }
+
+    boost::asio::ip::tcp::socket socket_;
+    std::vector<char> request_;
+    std::vector<char> reply_;
+    Clock::time_point sent_;
+    Clock::time_point deadline_;
+    std::vector<std::int64_t> latencies_;
+
+};
+
+struct Result
+{
+    double throughput_;
+    std::chrono::nanoseconds p50_;
+    std::chrono::nanoseconds p99_;
+    std::chrono::nanoseconds p999_;
+};
+
+static std::chrono::nanoseconds percentile(std::vector<std::int64_t>& latencies, double fraction)
+{
+    if (latencies.empty())
+    {
+        return std::chrono::nanoseconds::zero();
+    }
+
+    const std::size_t rank{ std::min(latencies.size() - 1, static_cast<std::size_t>(fraction * latencies.size())) };
+    std::nth_element(latencies.begin(), latencies.begin() + rank, latencies.end());
+    return std::chrono::nanoseconds{ latencies[rank] };
+}
+
+// Running closed-loop clients spread over threads, each thread driving its share of connections
+static Result measure(const boost::asio::ip::tcp::endpoint& server, std::size_t connections, std::size_t size,
+    Clock::duration duration, std::size_t threads)
+{
+    std::vector<std::unique_ptr<boost::asio::io_context>> contexts{};
+    std::vector<std::unique_ptr<Client>> clients{};
+    for (std::size_t t{ 0 }; t < threads; ++t)
+    {
+        contexts.push_back(std::make_unique<boost::asio::io_context>(1));
+    }
+    for (std::size_t c{ 0 }; c < connections; ++c)
+    {
+        clients.push_back(std::make_unique<Client>(*contexts[c % threads], server, size));
+    }
+
+    const Clock::time_point start{ Clock::now() };
+    for (const std::unique_ptr<Client>& client : clients)
+    {
+        client->start(start + duration);
+    }
+
+    std::vector<std::thread> runners{};
+    for (const std::unique_ptr<boost::asio::io_context>& context : contexts)
+    {
+        runners.emplace_back([&context]() { context->run(); });
+    }
+    for (std::thread& runner : runners)
+    {
+        runner.join();
+    }
+    const Clock::duration elapsed{ Clock::now() - start };
+
+    std::vector<std::int64_t> latencies{};
+    for (const std::unique_ptr<Client>& client : clients)
+    {
+        latencies.insert(latencies.end(), client->latencies().begin(), client->latencies().end());
+    }
+
+    const double seconds{ std::chrono::duration<double>(elapsed).count() };
+    return Result{ static_cast<double>(latencies.size()) / seconds,
+        percentile(latencies, 0.5), percentile(latencies, 0.99), percentile(latencies, 0.999) };
+}
+
+static std::vector<std::size_t> parse_list(const std::string& list)
+{
+    std::vector<std::size_t> values{};
+    std::istringstream stream{ list };
+    std::string value{};
+    while (std::getline(stream, value, ','))
+    {
+        values.push_back(static_cast<std::size_t>(std::stoul(value)));
+    }
+    return values;
+}
+
+// A load generator of the reactor: every connection sends a message and waits for its echo,
+// and the requests per second and the latency percentiles are reported for every number of connections
+// and every message size. It measures an echo reactor of its own unless it's given the port of a running server.
+//
+// Usage: ReactorLoad [port, 0 for its own reactor] [seconds per run] [connections, e.g. 1,16,128]
+//     [message sizes, e.g. 64,1024,16384] [client threads]
+int main(int argc, char* argv[])
+{
+    try
+    {
+        const std::uint16_t port{ argc > 1 ? static_cast<std::uint16_t>(std::stoul(argv[1])) : std::uint16_t{ 0 } };
+        const std::chrono::duration<double> seconds{ argc > 2 ? std::stod(argv[2]) : 2.0 };
+        const std::vector<std::size_t> connections{ parse_list(argc > 3 ? argv[3] : "1,16,128") };
+        const std::vector<std::size_t> sizes{ parse_list(argc > 4 ? argv[4] : "64,1024,16384") };
+        const std::size_t threads{ argc > 5 ? std::max<std::size_t>(std::stoul(argv[5]), 1) : std::size_t{ 1 } };
+
+        std::optional<Reactor> reactor{};
+        boost::asio::ip::tcp::endpoint server{ boost::asio::ip::address_v4::loopback(), port };
+        if (port == 0)
+        {
+            // Clients float, as they are to share processors with the loops anyway
+            reactor.emplace(Reactor::default_loop_count());
+            boost::asio::ip::tcp::endpoint any{ boost::asio::ip::address_v4::loopback(), 0 };
+            server.port(reactor->listen(any, [](const std::shared_ptr<Connection>& connection)
+            {
+                connection->on_read([](Connection& self, const SharedBuffer& data)
+                {
+                    self.write(data);
+                });
+            }).port());
+            reactor->start();
+        }
+
+        std::cout << std::setw(12) << "connections" << std::setw(10) << "size" << std::setw(14) << "requests/s"
+            << std::setw(12) << "p50, us" << std::setw(12) << "p99, us" << std::setw(12) << "p999, us" << std::endl;
+        for (const std::size_t count : connections)
+        {
+            for (const std::size_t size : sizes)
+            {
+                const Result result{ measure(server, std::max<std::size_t>(count, 1), std::max<std::size_t>(size, 1),
+                    std::chrono::duration_cast<Clock::duration>(seconds), threads) };
+                std::cout << std::setw(12) << count << std::setw(10) << size
+                    << std::setw(14) << std::fixed << std::setprecision(0) << result.throughput_ << std::setprecision(1)
+                    << std::setw(12) << result.p50_.count() / 1000.0
+                    << std::setw(12) << result.p99_.count() / 1000.0
+                    << std::setw(12) << result.p999_.count() / 1000.0 << std::endl;
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Fail to perform the task due to " << e.what() << std::endl;
+        return 1;
+    }
+    catch (...)
+    {
+        std::cerr << "Fail to perform the task due to an unknown exception" << std::endl;
+        return 2;
+    }
+
+    return 0;
+}
@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <utility>
+
+#include "TimerWheel.h"
+
+WheelTimer::WheelTimer() noexcept :
+    link_{ &link_, &link_, this },
+    wheel_{ nullptr },
+    expiry_{ 0 },
+    handler_{}
+{
+    // Empty
+}
+
+WheelTimer::~WheelTimer()
+{
+    if (scheduled())
+    {
+        wheel_->cancel(*this);
+    }
+}
+
+bool WheelTimer::scheduled() const noexcept
+{
+    return link_.next_ != &link_;
+}
+
+void WheelTimer::unlink() noexcept
+{
+    link_.prev_->next_ = link_.next_;
+    link_.next_->prev_ = link_.prev_;
+    link_.prev_ = &link_;
+    link_.next_ = &link_;
+}
+
+TimerWheel::TimerWheel(Clock::duration resolution, Clock::time_point origin) :
+    resolution_{ std::max(resolution, Clock::duration{ 1 }) },
+    origin_{ origin },
+    now_{ 0 },
+    size_{ 0 },
+    levels_{},
+    due_{}
+{
+    for (Level& level : levels_)
+    {
+        for (Slot& slot : level)
+        {
+            reset(slot);
+        }
+    }
+    reset(due_);
+}
+
+TimerWheel::~TimerWheel()
+{
+    // Timers outliving the wheel are left unscheduled
+    const auto release{ [](Slot& slot)
+    {
+        while (slot.next_ != &slot)
+        {
+            slot.next_->owner_->unlink();
+        }
+    } };
+
+    for (Level& level : levels_)
+    {
+        for (Slot& slot : level)
+        {
+            release(slot);
+        }
+    }
+    release(due_);
+}
+
+void TimerWheel::schedule(WheelTimer& timer, Clock::duration delay, Handler handler)
+{
+    cancel(timer);
+    timer.handler_ = std::move(handler);
+    timer.expiry_ = now_ + ticks_of(delay);
+    insert(timer);
+}
+
+void TimerWheel::rearm(WheelTimer& timer, Clock::duration delay)
+{
+    if (!timer.scheduled())
+    {
+        return;
+    }
+
+    cancel(timer);
+    timer.expiry_ = now_ + ticks_of(delay);
+    insert(timer);
+}
+
+void TimerWheel::cancel(WheelTimer& timer) noexcept
+{
+    if (timer.scheduled())
+    {
+        timer.unlink();
+        --size_;
+    }
+}
+
+std::size_t TimerWheel::advance(Clock::time_point now)
+{
+    if (now < origin_)
+    {
+        return 0;
+    }
+
+    const std::uint64_t target{ static_cast<std::uint64_t>((now - origin_) / resolution_) };
+    // Timeouts, which have been left due by a throwing handler, go first
+    std::size_t fired{ expire() };
+    while (now_ < target)
+    {
+        // An empty wheel has nothing to go through tick by tick
+        if (size_ == 0)
+        {
+            now_ = target;
+            break;
+        }
+
+        ++now_;
+        // Every time a level wraps around, a slot of the next one is spread over the ones below
+        for (std::size_t level{ 1 }; level < kLevels; ++level)
+        {
+            if ((now_ & ((std::uint64_t{ 1 } << (kSlotBits * level)) - 1)) != 0)
+            {
+                break;
+            }
+            cascade(level);
+        }
+
+        splice(levels_[0][now_ & (kSlots - 1)], due_);
+        fired += expire();
+    }
+    return fired;
+}
+
+TimerWheel::Clock::duration TimerWheel::resolution() const noexcept
+{
+    return resolution_;
+}
+
+std::size_t TimerWheel::size() const noexcept
+{
+    return size_;
+}
+
+bool TimerWheel::empty() const noexcept
+{
+    return size_ == 0;
+}
+
+std::uint64_t TimerWheel::ticks_of(Clock::duration delay) const noexcept
+{
+    if (delay <= Clock::duration::zero())
+    {
+        return 1;
+    }
+    return std::max<std::uint64_t>(static_cast<std::uint64_t>((delay + resolution_ - Clock::duration{ 1 }) / resolution_), 1);
+}
+
+void TimerWheel::insert(WheelTimer& timer) noexcept
+{
+    // A level is the first one to span the delay, so that a timeout never lands into a slot, which has been passed
+    const std::uint64_t delay{ timer.expiry_ - now_ };
+    std::size_t level{ 0 };
+    while (level + 1 < kLevels && delay >= (std::uint64_t{ 1 } << (kSlotBits * (level + 1))))
+    {
+        ++level;
+    }
+
+    // Distant timeouts are parked at the farthest slot of the top level, and placed again once they reach it
+    const std::uint64_t horizon{ now_ + (std::uint64_t{ 1 } << (kSlotBits * kLevels)) - 1 };
+    const std::uint64_t expiry{ std::min(timer.expiry_, horizon) };
+    append(levels_[level][(expiry >> (kSlotBits * level)) & (kSlots - 1)], timer.link_);
+    timer.wheel_ = this;
+    ++size_;
+}
+
+void TimerWheel::cascade(std::size_t level) noexcept
+{
+    Slot moving{};
+    reset(moving);
+    splice(levels_[level][(now_ >> (kSlotBits * level)) & (kSlots - 1)], moving);
+    while (moving.next_ != &moving)
+    {
+        WheelTimer& timer{ *moving.next_->owner_ };
+        timer.unlink();
+        --size_;
+        insert(timer);
+    }
+}
+
+std::size_t TimerWheel::expire()
+{
+    std::size_t fired{ 0 };
+    while (due_.next_ != &due_)
+    {
+        WheelTimer& timer{ *due_.next_->owner_ };
+        timer.unlink();
+        --size_;
+
+        // A handler may schedule its timer again or destroy it, so it's run off the timer
+        const Handler handler{ std::move(timer.handler_) };
+        timer.handler_ = nullptr;
+        ++fired;
+        if (handler)
+        {
+            handler();
+        }
+    }
+    return fired;
+}
+
+void TimerWheel::reset(Slot& slot) noexcept
+{
+    slot.prev_ = &slot;
+    slot.next_ = &slot;
+    slot.owner_ = nullptr;
+}
+
+void TimerWheel::append(Slot& slot, Slot& link) noexcept
+{
+    link.prev_ = slot.prev_;
+    link.next_ = &slot;
+    slot.prev_->next_ = &link;
+    slot.prev_ = &link;
+}
+
+void TimerWheel::splice(Slot& from, Slot& to) noexcept
+{
+    if (from.next_ == &from)
+    {
+        return;
+    }
+
+    from.next_->prev_ = to.prev_;
+    to.prev_->next_ = from.next_;
+    from.prev_->next_ = &to;
+    to.prev_ = from.prev_;
+    from.prev_ = &from;
+    from.next_ = &from;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <chrono>
+#include <functional>
+
+class TimerWheel;
+
+// A timeout registered at a timer wheel. It's embedded into its owner, so scheduling it allocates nothing,
+// and it's cancelled when it's gone
+class WheelTimer
+{
+public:
+    using Handler = std::function<void()>;
+
+    WheelTimer(const WheelTimer& other) = delete;
+    WheelTimer(WheelTimer&& other) = delete;
+    WheelTimer& operator=(const WheelTimer& other) = delete;
+    WheelTimer& operator=(WheelTimer&& other) = delete;
+
+    WheelTimer() noexcept;
+    ~WheelTimer();
+
+    bool scheduled() const noexcept;
+
+private:
+    friend class TimerWheel;
+
+    // A link of a circular list of a slot, which is owned by no timer for the head of the list
+    struct Link
+    {
+        Link* prev_;
+        Link* next_;
+        WheelTimer* owner_;
+    };
+
+    void unlink() noexcept;
+
+    Link link_;
+    TimerWheel* wheel_;
+    std::uint64_t expiry_;
+    Handler handler_;
+
+};
+
+// A hierarchical timer wheel, which keeps timeouts in slots of ticks rather than in a heap:
+// the first level holds the next 64 ticks, every next level holds 64 slots of the previous one,
+// and timeouts cascade down the levels as their time comes. Scheduling, cancelling and rearming a timeout
+// are O(1), which makes a timeout per connection, rearmed at every read, cheap for any number of connections,
+// while a single tick of the owner drives them all.
+//
+// A wheel is single-threaded: it's to be touched by the thread of its loop only. Delays are rounded up
+// to whole ticks, and the ones longer than 64^4 ticks keep waiting at the top level
+class TimerWheel
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using Handler = WheelTimer::Handler;
+
+    static constexpr std::size_t kLevels{ 4 };
+    static constexpr std::size_t kSlotBits{ 6 };
+    static constexpr std::size_t kSlots{ std::size_t{ 1 } << kSlotBits };
+    static constexpr Clock::duration kDefaultResolution{ std::chrono::milliseconds{ 10 } };
+
+    TimerWheel(const TimerWheel& other) = delete;
+    TimerWheel(TimerWheel&& other) = delete;
+    TimerWheel& operator=(const TimerWheel& other) = delete;
+    TimerWheel& operator=(TimerWheel&& other) = delete;
+
+    explicit TimerWheel(Clock::duration resolution = kDefaultResolution, Clock::time_point origin = Clock::now());
+    ~TimerWheel();
+
+    // Running a handler after a delay, which replaces the pending one of the timer if any
+    void schedule(WheelTimer& timer, Clock::duration delay, Handler handler);
+    // Moving the expiry of a pending timer keeping its handler. A fired timer has given its handler away,
+    // so it's to be scheduled anew
+    void rearm(WheelTimer& timer, Clock::duration delay);
+    void cancel(WheelTimer& timer) noexcept;
+
+    // Running handlers of the timeouts due by now, which may schedule timeouts in their turn
+    std::size_t advance(Clock::time_point now);
+
+    Clock::duration resolution() const noexcept;
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+
+private:
+
+    using Slot = WheelTimer::Link;
+    using Level = std::array<Slot, kSlots>;
+
+    std::uint64_t ticks_of(Clock::duration delay) const noexcept;
+    void insert(WheelTimer& timer) noexcept;
+    void cascade(std::size_t level) noexcept;
+    std::size_t expire();
+
+    static void reset(Slot& slot) noexcept;
+    static void append(Slot& slot, Slot& link) noexcept;
+    static void splice(Slot& from, Slot& to) noexcept;
+
+    const Clock::duration resolution_;
+    const Clock::time_point origin_;
+    std::uint64_t now_;
+    std::size_t size_;
+    std::array<Level, kLevels> levels_;
+    // Timeouts of the current tick, which are still to fire
+    Slot due_;
+
+};
@@ -1,14 +1,75 @@
+#include <cstdint>
+#include <chrono>
 #include <iostream>
 #include <exception>
+#include <iomanip>
+#include <memory>
+#include <string>
 
-#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/signal_set.hpp>
 
-int main()
+#include "Connection.h"
+#include "LoopStats.h"
+#include "Reactor.h"
+
+// Statistics of every loop, which reveal handlers stalling their loops
+static void report(Reactor& reactor)
+{
+    static constexpr const char* kNames[kHandlerKinds]{ "post", "timer", "timeout", "accept", "read", "write" };
+
+    for (std::size_t l{ 0 }; l < reactor.loop_count(); ++l)
+    {
+        const LoopStatsSnapshot snapshot{ reactor.loop(l).stats().snapshot() };
+        std::cout << "Loop " << l << " has been busy for " << std::fixed << std::setprecision(2)
+            << snapshot.utilization() * 100.0 << "% of the time with " << snapshot.queued_ << " handlers queued and "
+            << snapshot.outstanding_ << " operations outstanding" << std::endl;
+        for (std::size_t k{ 0 }; k < kHandlerKinds; ++k)
+        {
+            const HandlerStats& handlers{ snapshot.handlers_[k] };
+            if (handlers.calls_ == 0)
+            {
+                continue;
+            }
+            std::cout << "    " << kNames[k] << ": " << handlers.calls_ << " calls, "
+                << handlers.busy_.count() / static_cast<std::int64_t>(handlers.calls_) << " ns on average, "
+                << handlers.longest_.count() << " ns at most" << std::endl;
+        }
+    }
+}
+
+// An echo server on top of the reactor.
+//
+// Usage: Reactor [port] [number of event loops] [idle timeout in seconds, none by default]
+int main(int argc, char* argv[])
 {
     try
     {
-        boost::asio::io_context io_context{};
-        io_context.run();
+        const std::uint16_t port{ argc > 1 ? static_cast<std::uint16_t>(std::stoul(argv[1])) : std::uint16_t{ 5555 } };
+        const std::size_t loops{ argc > 2 ? static_cast<std::size_t>(std::stoul(argv[2])) : Reactor::default_loop_count() };
+        const std::chrono::seconds idle{ argc > 3 ? std::stol(argv[3]) : 0 };
+
+        Reactor reactor{ loops };
+        reactor.listen(boost::asio::ip::tcp::endpoint{ boost::asio::ip::tcp::v4(), port },
+            [idle](const std::shared_ptr<Connection>& connection)
+        {
+            connection->idle_timeout(idle);
+            // The data goes back in the very buffer it has been read into
+            connection->on_read([](Connection& self, const SharedBuffer& data)
+            {
+                self.write(data);
+            });
+        });
+
+        boost::asio::signal_set signals{ reactor.loop(0).context(), SIGINT, SIGTERM };
+        signals.async_wait([&reactor](const boost::system::error_code&, int)
+        {
+            reactor.stop();
+        });
+
+        std::cout << "Echoing at port " << port << " with " << reactor.loop_count() << " event loops" << std::endl;
+        reactor.run();
+        report(reactor);
     }
     catch (const std::exception& e)
     {
@@ -22,4 +83,4 @@ int main()
     }
 
     return 0;
-}
\ No newline at end of file
+}
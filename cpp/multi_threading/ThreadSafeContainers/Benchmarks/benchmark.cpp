@@ -0,0 +1,376 @@
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <BluntQueue.hpp>
+#include <ChunkedQueue.hpp>
+#include <FineQueue.hpp>
+#include <LockFreeQueue.hpp>
+#include <RelaxedPriorityQueue.hpp>
+#include <ShardedQueue.hpp>
+#include <SpscQueue.hpp>
+#include <ThreadStorage.h>
+
+// Measuring throughput and enqueue-to-dequeue latency of the queues across numbers of producers
+// and consumers, payload sizes, trying and waiting pops, and single and batched operations.
+//
+// Usage: Benchmarks [max threads per side] [elements per run] [queue name, all of them by default]
+
+using Clock = std::chrono::steady_clock;
+
+// An element carries the moment it's been pushed at, padded up to the payload size
+template <std::size_t Size>
+struct Payload
+{
+    static_assert(Size >= sizeof(std::int64_t), "Expecting a payload to fit a time stamp");
+
+    std::int64_t stamp_;
+    std::array<unsigned char, Size - sizeof(std::int64_t)> padding_;
+};
+
+enum class PopMode
+{
+    Try,
+    Wait
+};
+
+struct Scenario
+{
+    unsigned producers_;
+    unsigned consumers_;
+    PopMode pop_;
+    bool batch_;
+};
+
+struct Result
+{
+    double opsPerSecond_;
+    std::int64_t p50_;
+    std::int64_t p99_;
+    std::int64_t p999_;
+};
+
+constexpr std::size_t kBatchSize{ 32 };
+
+// Capabilities of the queues, which are not shared by all of them
+template <typename Queue>
+struct QueueTraits
+{
+    static constexpr bool kBatches{ true };
+    static constexpr bool kSingleProducerConsumer{ false };
+};
+
+template <typename T, typename Wait>
+struct QueueTraits<LockFreeQueue<T, Wait>>
+{
+    static constexpr bool kBatches{ false };
+    static constexpr bool kSingleProducerConsumer{ false };
+};
+
+template <typename T, typename Compare, typename Wait>
+struct QueueTraits<RelaxedPriorityQueue<T, Compare, Wait>>
+{
+    static constexpr bool kBatches{ false };
+    static constexpr bool kSingleProducerConsumer{ false };
+};
+
+template <typename T, typename Shard, typename Wait>
+struct QueueTraits<ShardedQueue<T, Shard, Wait>>
+{
+    static constexpr bool kBatches{ false };
+    static constexpr bool kSingleProducerConsumer{ false };
+};
+
+template <typename T, std::size_t Capacity>
+struct QueueTraits<SpscQueue<T, Capacity>>
+{
+    static constexpr bool kBatches{ false };
+    static constexpr bool kSingleProducerConsumer{ true };
+};
+
+// Prioritizing earlier pushed elements, like a deadline scheduler would do
+struct EarlierStamp
+{
+    template <typename T>
+    bool operator()(const T& one, const T& other) const noexcept
+    {
+        return one.stamp_ < other.stamp_;
+    }
+};
+
+// Families of queues under comparison, which are to be extended by new variants
+template <typename T>
+using Blunt = BluntQueue<T>;
+template <typename T>
+using Fine = FineQueue<T>;
+template <typename T>
+using FinePooled = FineQueue<T, PooledElements>;
+template <typename T>
+using Chunked = ChunkedQueue<T>;
+template <typename T>
+using LockFree = LockFreeQueue<T>;
+template <typename T>
+using Relaxed = RelaxedPriorityQueue<T, EarlierStamp>;
+template <typename T>
+using Sharded = ShardedQueue<T>;
+template <typename T>
+using Spsc = SpscQueue<T, 1024>;
+
+std::int64_t now() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+template <typename Queue, typename T>
+void produce(Queue& queue, const std::size_t count, const bool batch)
+{
+    if constexpr (QueueTraits<Queue>::kBatches)
+    {
+        if (batch)
+        {
+            std::vector<T> values(kBatchSize);
+            for (std::size_t sent{ 0 }; sent < count;)
+            {
+                const std::size_t n{ std::min(kBatchSize, count - sent) };
+                const std::int64_t stamp{ now() };
+                for (std::size_t i{ 0 }; i < n; ++i)
+                {
+                    values[i].stamp_ = stamp;
+                }
+                queue.push_bulk(std::span<T>{ values.data(), n });
+                sent += n;
+            }
+            return;
+        }
+    }
+
+    T value{};
+    for (std::size_t sent{ 0 }; sent < count; ++sent)
+    {
+        value.stamp_ = now();
+        queue.push(value);
+    }
+}
+
+template <typename Queue, typename T>
+void consume(Queue& queue, const std::size_t count, const Scenario& scenario, std::vector<std::int64_t>& latencies)
+{
+    if constexpr (QueueTraits<Queue>::kBatches)
+    {
+        if (scenario.batch_)
+        {
+            std::vector<T> values{};
+            values.reserve(kBatchSize);
+            for (std::size_t received{ 0 }; received < count;)
+            {
+                values.clear();
+                const std::size_t limit{ std::min(kBatchSize, count - received) };
+                const std::size_t n{ scenario.pop_ == PopMode::Wait ?
+                    queue.wait_and_pop_bulk(std::back_inserter(values), limit) :
+                    queue.try_pop_bulk(std::back_inserter(values), limit) };
+                if (n == 0)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                const std::int64_t stamp{ now() };
+                for (const T& value : values)
+                {
+                    latencies.push_back(stamp - value.stamp_);
+                }
+                received += n;
+            }
+            return;
+        }
+    }
+
+    T value{};
+    for (std::size_t received{ 0 }; received < count;)
+    {
+        if (scenario.pop_ == PopMode::Wait)
+        {
+            queue.wait_and_pop(value);
+        }
+        else if (!queue.try_pop(value))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        latencies.push_back(now() - value.stamp_);
+        ++received;
+    }
+}
+
+std::int64_t percentile(const std::vector<std::int64_t>& sorted, const double fraction)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+
+    const std::size_t index{ static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1)) };
+    return sorted[index];
+}
+
+// Every producer sends the same number of elements to every consumer in average,
+// so that all consumers are able to complete their quotas with waiting pops
+template <typename Queue, typename T>
+Result measure(const Scenario& scenario, const std::size_t perPair)
+{
+    const std::size_t perProducer{ scenario.consumers_ * perPair };
+    const std::size_t perConsumer{ scenario.producers_ * perPair };
+    const unsigned threadCount{ scenario.producers_ + scenario.consumers_ };
+
+    Queue queue{};
+    std::vector<std::vector<std::int64_t>> latencies(scenario.consumers_);
+    std::vector<Clock::time_point> finished(scenario.consumers_);
+    std::atomic<unsigned> ready{ 0 };
+    std::atomic<bool> go{ false };
+    Clock::time_point start{};
+    {
+        const auto wait_for_start = [&ready, &go]()
+        {
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+        };
+
+        ThreadStorage threads{ threadCount };
+        for (unsigned p{ 0 }; p < scenario.producers_; ++p)
+        {
+            threads[p] = std::thread{ [&queue, &scenario, &wait_for_start, perProducer]()
+            {
+                wait_for_start();
+                produce<Queue, T>(queue, perProducer, scenario.batch_);
+            } };
+        }
+        for (unsigned c{ 0 }; c < scenario.consumers_; ++c)
+        {
+            latencies[c].reserve(perConsumer);
+            threads[scenario.producers_ + c] = std::thread{
+                [&queue, &scenario, &wait_for_start, &latencies, &finished, perConsumer, c]()
+            {
+                wait_for_start();
+                consume<Queue, T>(queue, perConsumer, scenario, latencies[c]);
+                finished[c] = Clock::now();
+            } };
+        }
+
+        while (ready.load() != threadCount)
+        {
+            std::this_thread::yield();
+        }
+        start = Clock::now();
+        go.store(true, std::memory_order_release);
+    }
+
+    std::vector<std::int64_t> all{};
+    all.reserve(perConsumer * scenario.consumers_);
+    for (const std::vector<std::int64_t>& l : latencies)
+    {
+        all.insert(all.end(), l.cbegin(), l.cend());
+    }
+    std::sort(all.begin(), all.end());
+
+    const Clock::time_point end{ *std::max_element(finished.cbegin(), finished.cend()) };
+    const double seconds{ std::chrono::duration<double>(end - start).count() };
+    return Result{ static_cast<double>(all.size()) / seconds,
+        percentile(all, 0.5), percentile(all, 0.99), percentile(all, 0.999) };
+}
+
+void print_header()
+{
+    std::cout << std::left << std::setw(12) << "queue" << std::right
+        << std::setw(4) << "P" << std::setw(4) << "C" << std::setw(9) << "payload"
+        << std::setw(6) << "pop" << std::setw(8) << "mode"
+        << std::setw(14) << "ops/s" << std::setw(12) << "p50,ns" << std::setw(12) << "p99,ns"
+        << std::setw(12) << "p999,ns" << '\n';
+}
+
+void print_row(const std::string_view name, const Scenario& scenario, const std::size_t payload, const Result& result)
+{
+    std::cout << std::left << std::setw(12) << name << std::right
+        << std::setw(4) << scenario.producers_ << std::setw(4) << scenario.consumers_
+        << std::setw(9) << payload << std::setw(6) << (scenario.pop_ == PopMode::Wait ? "wait" : "try")
+        << std::setw(8) << (scenario.batch_ ? "batch" : "single")
+        << std::setw(14) << std::fixed << std::setprecision(0) << result.opsPerSecond_
+        << std::setw(12) << result.p50_ << std::setw(12) << result.p99_ << std::setw(12) << result.p999_ << '\n';
+}
+
+template <template <typename> class Queue, std::size_t Size>
+void run_payload(const std::string_view name, const unsigned maxThreads, const std::size_t elements)
+{
+    using Tested = Queue<Payload<Size>>;
+    using Traits = QueueTraits<Tested>;
+
+    const unsigned maxSide{ Traits::kSingleProducerConsumer ? 1u : maxThreads };
+    for (unsigned producers{ 1 }; producers <= maxSide; producers *= 2)
+    {
+        for (unsigned consumers{ 1 }; consumers <= maxSide; consumers *= 2)
+        {
+            for (const PopMode pop : { PopMode::Try, PopMode::Wait })
+            {
+                for (const bool batch : { false, true })
+                {
+                    if (batch && !Traits::kBatches)
+                    {
+                        continue;
+                    }
+
+                    const Scenario scenario{ producers, consumers, pop, batch };
+                    const std::size_t perPair{ std::max<std::size_t>(1, elements / (producers * consumers)) };
+                    print_row(name, scenario, Size, measure<Tested, Payload<Size>>(scenario, perPair));
+                }
+            }
+        }
+    }
+}
+
+template <template <typename> class Queue>
+void run_family(const std::string_view name, const std::string_view filter,
+    const unsigned maxThreads, const std::size_t elements)
+{
+    // A filter names a single family, so that Fine doesn't pull FinePooled in
+    if (!filter.empty() && name != filter)
+    {
+        return;
+    }
+
+    run_payload<Queue, 8>(name, maxThreads, elements);
+    run_payload<Queue, 64>(name, maxThreads, elements);
+    run_payload<Queue, 1024>(name, maxThreads, elements);
+}
+
+int main(int argc, char* argv[])
+{
+    const unsigned maxThreads{ argc > 1 ? static_cast<unsigned>(std::stoul(argv[1])) : 4u };
+    const std::size_t elements{ argc > 2 ? static_cast<std::size_t>(std::stoull(argv[2])) : std::size_t{ 1 } << 16 };
+    const std::string_view filter{ argc > 3 ? argv[3] : "" };
+
+    print_header();
+    run_family<Blunt>("Blunt", filter, maxThreads, elements);
+    run_family<Fine>("Fine", filter, maxThreads, elements);
+    run_family<FinePooled>("FinePooled", filter, maxThreads, elements);
+    run_family<Chunked>("Chunked", filter, maxThreads, elements);
+    run_family<LockFree>("LockFree", filter, maxThreads, elements);
+    run_family<Relaxed>("Relaxed", filter, maxThreads, elements);
+    run_family<Sharded>("Sharded", filter, maxThreads, elements);
+    run_family<Spsc>("Spsc", filter, maxThreads, elements);
+
+    return 0;
+}
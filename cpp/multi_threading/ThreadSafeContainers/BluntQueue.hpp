@@ -1,19 +1,37 @@
 ﻿#pragma once
 
+#include <cstddef>
+#include <coroutine>
 #include <mutex>
-#include <condition_variable>
 #include <memory>
 #include <initializer_list>
 #include <deque>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
 #include <utility>
 
+#include "QueueStats.hpp"
+#include "WaitPolicies.hpp"
+
+// Wrapping a limit of elements to tell it apart from an initializer list of elements
+struct QueueCapacity
+{
+    std::size_t value_;
+};
+
 // Forward declaring equality operator to make it a friend of the queue
-template <typename T>
+template <typename T, typename Wait = BlockWait, typename Stats = NoStats>
 class BluntQueue;
-template <typename T>
-bool operator==(const BluntQueue<T>& one, const BluntQueue<T>& other);
+template <typename T, typename Wait, typename Stats>
+bool operator==(const BluntQueue<T, Wait, Stats>& one, const BluntQueue<T, Wait, Stats>& other);
 
-template <typename T>
+// Producers of a bounded queue and consumers block according to the wait policy,
+// whereas the statistics policy accounts the traffic and the contention, if enabled
+template <typename T, typename Wait, typename Stats>
 class BluntQueue
 {
 public:
@@ -22,6 +40,10 @@ public:
     BluntQueue() = default;
     BluntQueue(std::initializer_list<T> items);
 
+    // Bounding the queue makes producers wait for consumers, instead of growing the storage endlessly.
+    // A queue without a room for a single element would block every producer, so a zero capacity is rejected
+    explicit BluntQueue(QueueCapacity capacity);
+
     BluntQueue(const BluntQueue& other);
     BluntQueue(BluntQueue&& other) noexcept;
 
@@ -30,13 +52,28 @@ public:
 
     ~BluntQueue() noexcept = default;
 
-    // Pushing objects, which are not performance critical, by value
+    // Pushing objects, which are not performance critical, by value.
+    // A bounded queue blocks a producer while it is full, a closed queue discards the value
     void push(T value);
 
     // Constructing performance critical objects emplace
     template <typename... Args>
     void emplace(Args&&... args);
 
+    // Providing pushes, which report a failure to enqueue a value:
+    // a waiting push fails only when the queue is closed, whereas a trying one also fails when the queue is full.
+    // A rejected value is left intact for the trying pushes
+    bool wait_and_push(T value);
+    bool try_push(const T& value);
+    bool try_push(T&& value);
+
+    // Pushing batches under a single lock and with a single notification of consumers.
+    // A bounded queue accepts a batch piecewise as long as it's got a room for elements.
+    // The number of accepted elements is returned, which is less than requested only for a closed queue
+    template <typename InputIt>
+    size_type push_range(InputIt first, InputIt last);
+    size_type push_bulk(std::span<T> values);
+
     // Providing complete pop operations, rather than the classical front / pop tandem
     // to avoid race conditions inherited in the interface
 
@@ -48,181 +85,629 @@ public:
     // a managed pointer to a value of interest
     std::shared_ptr<T> try_pop();
 
-    // Providing waiting pops for those consumers, which are willing to wait for a value
+    // Providing waiting pops for those consumers, which are willing to wait for a value.
+    // They give up only when the queue is closed and drained
     bool wait_and_pop(T& value);
     std::shared_ptr<T> wait_and_pop();
 
+    // Popping up to the given number of elements at once, returning the number of retrieved ones.
+    // A waiting version waits for at least one element, unless the queue is closed and drained
+    template <typename OutputIt>
+    size_type try_pop_bulk(OutputIt out, size_type maxCount);
+    template <typename OutputIt>
+    size_type wait_and_pop_bulk(OutputIt out, size_type maxCount);
+
+    // Awaiting an element in a coroutine instead of blocking a thread: co_await queue.async_pop(executor)
+    // yields an optional element, which is empty once the queue is closed and drained.
+    // A suspended coroutine is resumed through post(executor, handler) found by argument-dependent lookup,
+    // e.g. boost::asio::post of an io_context executor, whereas an element at hand is taken right away.
+    // Awaiting consumers are served before the blocking ones. They belong to the queue rather than
+    // to its content, so a queue is to be closed before its destruction to release them
+    template <typename Executor>
+    class PopAwaitable;
+
+    template <typename Executor>
+    PopAwaitable<Executor> async_pop(Executor executor);
+
+    // Closing the queue rejects further pushes and wakes up all waiting threads and coroutines,
+    // so that consumers drain remaining elements and stop then
+    void close();
+    bool closed() const;
+
     bool empty() const;
     size_type size() const;
+    size_type capacity() const;
 
-    void swap(BluntQueue<T>& other);
+    // Reading counters of the statistics policy, e.g. by stats().snapshot()
+    const Stats& stats() const noexcept;
 
-    friend bool operator==<T>(const BluntQueue<T>& one, const BluntQueue<T>& other);
+    void swap(BluntQueue<T, Wait, Stats>& other);
+
+    friend bool operator==<T, Wait, Stats>(const BluntQueue<T, Wait, Stats>& one, const BluntQueue<T, Wait, Stats>& other);
 
 private:
 
+    static constexpr size_type kUnbounded{ std::numeric_limits<size_type>::max() };
+
+    // A suspended coroutine, which is linked into the queue of awaiters and handed an element under the lock
+    struct AsyncWaiter
+    {
+        AsyncWaiter* next_{ nullptr };
+        std::optional<T> value_{};
+        void (*resume_)(AsyncWaiter& waiter){ nullptr };
+    };
+
+    bool suspend_pop(AsyncWaiter& waiter);
+    // Handing the front elements to awaiters, or nothing once closed, under the lock.
+    // Served awaiters are chained to be resumed after the lock is released
+    AsyncWaiter* serve_waiters();
+    static void resume_waiters(AsyncWaiter* served);
+
+    template <typename... Args>
+    bool lock_emplace_back(Args&&... args);
+    template <typename U>
+    bool lock_try_push(U&& value);
+    std::unique_lock<std::mutex> wait_for_front();
+    template <typename OutputIt>
+    size_type move_front(OutputIt out, size_type maxCount);
+    static void notify(Wait& condition, size_type count);
+
     mutable std::mutex mutex_;
-    std::condition_variable isPopulated_;
+    Wait isPopulated_;
+    Wait isVacant_;
     std::deque<T> storage_;
+    // A capacity belongs to the content and travels along with it, whereas a closure belongs to the queue
+    size_type capacity_{ kUnbounded };
+    bool closed_{ false };
+    AsyncWaiter* waitersHead_{ nullptr };
+    AsyncWaiter* waitersTail_{ nullptr };
+    QUEUE_NO_UNIQUE_ADDRESS mutable Stats stats_{};
+
+};
+
+template <typename T, typename Wait, typename Stats>
+template <typename Executor>
+class BluntQueue<T, Wait, Stats>::PopAwaitable : private BluntQueue<T, Wait, Stats>::AsyncWaiter
+{
+public:
+
+    PopAwaitable(BluntQueue& queue, Executor executor);
+
+    PopAwaitable(const PopAwaitable& other) = delete;
+    PopAwaitable& operator=(const PopAwaitable& other) = delete;
+
+    bool await_ready() const noexcept;
+    bool await_suspend(std::coroutine_handle<> handle);
+    std::optional<T> await_resume();
+
+private:
+
+    static void resume(AsyncWaiter& waiter);
+
+    BluntQueue& queue_;
+    Executor executor_;
+    std::coroutine_handle<> handle_;
 
 };
 
-template <typename T>
-bool operator==(const BluntQueue<T>& one, const BluntQueue<T>& other)
+template <typename T, typename Wait, typename Stats>
+template <typename Executor>
+BluntQueue<T, Wait, Stats>::PopAwaitable<Executor>::PopAwaitable(BluntQueue& queue, Executor executor) :
+    AsyncWaiter{},
+    queue_{ queue },
+    executor_{ std::move(executor) },
+    handle_{}
+{
+    this->resume_ = &PopAwaitable::resume;
+}
+
+template <typename T, typename Wait, typename Stats>
+template <typename Executor>
+bool BluntQueue<T, Wait, Stats>::PopAwaitable<Executor>::await_ready() const noexcept
+{
+    return false;
+}
+
+template <typename T, typename Wait, typename Stats>
+template <typename Executor>
+bool BluntQueue<T, Wait, Stats>::PopAwaitable<Executor>::await_suspend(std::coroutine_handle<> handle)
+{
+    handle_ = handle;
+    return queue_.suspend_pop(*this);
+}
+
+template <typename T, typename Wait, typename Stats>
+template <typename Executor>
+std::optional<T> BluntQueue<T, Wait, Stats>::PopAwaitable<Executor>::await_resume()
+{
+    return std::move(this->value_);
+}
+
+template <typename T, typename Wait, typename Stats>
+template <typename Executor>
+void BluntQueue<T, Wait, Stats>::PopAwaitable<Executor>::resume(AsyncWaiter& waiter)
+{
+    // The coroutine might be resumed and gone before post returns, so nothing of the awaitable is used then
+    PopAwaitable& self{ static_cast<PopAwaitable&>(waiter) };
+    Executor executor{ self.executor_ };
+    post(executor, [handle = self.handle_]() { handle.resume(); });
+}
+
+template <typename T, typename Wait, typename Stats>
+bool operator==(const BluntQueue<T, Wait, Stats>& one, const BluntQueue<T, Wait, Stats>& other)
 {
     std::scoped_lock<std::mutex, std::mutex> lock{ one.mutex_, other.mutex_ };
     return one.storage_ == other.storage_;
 }
 
-template <typename T>
-BluntQueue<T>::BluntQueue(std::initializer_list<T> items) :
+template <typename T, typename Wait, typename Stats>
+BluntQueue<T, Wait, Stats>::BluntQueue(std::initializer_list<T> items) :
     mutex_{},
     isPopulated_{},
+    isVacant_{},
     storage_{ items.begin(), items.end() }
 {
-    // Empty
+    stats_.pushed(storage_.size());
 }
 
-template <typename T>
-BluntQueue<T>::BluntQueue(const BluntQueue& other) :
+template <typename T, typename Wait, typename Stats>
+BluntQueue<T, Wait, Stats>::BluntQueue(QueueCapacity capacity) :
     mutex_{},
-    isPopulated_{}
+    isPopulated_{},
+    isVacant_{},
+    storage_{},
+    capacity_{ capacity.value_ }
+{
+    if (capacity_ == 0)
+    {
+        throw std::invalid_argument{ "Bounding a queue to no elements at all" };
+    }
+}
+
+template <typename T, typename Wait, typename Stats>
+BluntQueue<T, Wait, Stats>::BluntQueue(const BluntQueue& other) :
+    mutex_{},
+    isPopulated_{},
+    isVacant_{}
 {
     std::lock_guard<std::mutex> lock{ other.mutex_ };
     const auto& storage = other.storage_;
     storage_.assign(storage.cbegin(), storage.cend());
+    capacity_ = other.capacity_;
+    stats_.pushed(storage_.size());
 }
 
-template <typename T>
-BluntQueue<T>::BluntQueue(BluntQueue&& other) noexcept :
+template <typename T, typename Wait, typename Stats>
+BluntQueue<T, Wait, Stats>::BluntQueue(BluntQueue&& other) noexcept :
     mutex_{},
-    isPopulated_{}
+    isPopulated_{},
+    isVacant_{}
 {
     std::lock_guard<std::mutex> lock{ other.mutex_ };
     storage_ = std::move(other.storage_);
+    capacity_ = other.capacity_;
+    stats_.pushed(storage_.size());
 }
 
-template <typename T>
-BluntQueue<T>& BluntQueue<T>::operator=(const BluntQueue& other)
+template <typename T, typename Wait, typename Stats>
+BluntQueue<T, Wait, Stats>& BluntQueue<T, Wait, Stats>::operator=(const BluntQueue& other)
 {
+    AsyncWaiter* served{ nullptr };
     {
         // Reducing the locking scope to let a thread waiting a notification to acquire the mutex faster
         std::scoped_lock<std::mutex, std::mutex> lock{ mutex_, other.mutex_ };
         storage_.assign(other.storage_.begin(), other.storage_.end());
+        capacity_ = other.capacity_;
+        served = serve_waiters();
     }
+    resume_waiters(served);
     isPopulated_.notify_one();
+    isVacant_.notify_all();
     return *this;
 }
 
-template <typename T>
-BluntQueue<T>& BluntQueue<T>::operator=(BluntQueue&& other) noexcept
+template <typename T, typename Wait, typename Stats>
+BluntQueue<T, Wait, Stats>& BluntQueue<T, Wait, Stats>::operator=(BluntQueue&& other) noexcept
 {
+    AsyncWaiter* served{ nullptr };
     {
         std::scoped_lock<std::mutex, std::mutex> lock{ mutex_, other.mutex_ };
         storage_ = std::move(other.storage_);
+        capacity_ = other.capacity_;
+        served = serve_waiters();
     }
+    resume_waiters(served);
     isPopulated_.notify_one();
+    isVacant_.notify_all();
+    other.isVacant_.notify_all();
     return *this;
 }
 
-template <typename T>
-void BluntQueue<T>::push(T value)
+template <typename T, typename Wait, typename Stats>
+void BluntQueue<T, Wait, Stats>::push(T value)
 {
-    {
-        std::lock_guard<std::mutex> lock{ mutex_ };
-        storage_.push_back(std::move(value));
-    }
-    isPopulated_.notify_one();
+    lock_emplace_back(std::move(value));
 }
 
-template <typename T>
+template <typename T, typename Wait, typename Stats>
 template <typename... Args>
-void BluntQueue<T>::emplace(Args&& ... args)
+void BluntQueue<T, Wait, Stats>::emplace(Args&& ... args)
+{
+    lock_emplace_back(std::forward<Args>(args)...);
+}
+
+template <typename T, typename Wait, typename Stats>
+bool BluntQueue<T, Wait, Stats>::wait_and_push(T value)
 {
+    return lock_emplace_back(std::move(value));
+}
+
+template <typename T, typename Wait, typename Stats>
+bool BluntQueue<T, Wait, Stats>::try_push(const T& value)
+{
+    return lock_try_push(value);
+}
+
+template <typename T, typename Wait, typename Stats>
+bool BluntQueue<T, Wait, Stats>::try_push(T&& value)
+{
+    return lock_try_push(std::move(value));
+}
+
+template <typename T, typename Wait, typename Stats>
+template <typename InputIt>
+typename BluntQueue<T, Wait, Stats>::size_type BluntQueue<T, Wait, Stats>::push_range(InputIt first, InputIt last)
+{
+    size_type count{ 0 };
+    while (first != last)
     {
-        std::lock_guard<std::mutex> lock{ mutex_ };
-        storage_.emplace_back(std::forward<Args>(args)...);
+        size_type chunk{ 0 };
+        AsyncWaiter* served{ nullptr };
+        {
+            std::unique_lock<std::mutex> lock{ stats_.lock(mutex_, LockSite::Storage) };
+            stats_.wait(isVacant_, lock, [this]() { return closed_ || storage_.size() < capacity_; },
+                WaitSite::Push);
+            if (closed_)
+            {
+                break;
+            }
+
+            for (; first != last && storage_.size() < capacity_; ++first)
+            {
+                storage_.push_back(*first);
+                ++chunk;
+            }
+            stats_.pushed(chunk);
+            served = serve_waiters();
+        }
+        resume_waiters(served);
+        notify(isPopulated_, chunk);
+        count += chunk;
     }
-    isPopulated_.notify_one();
+    return count;
+}
+
+template <typename T, typename Wait, typename Stats>
+typename BluntQueue<T, Wait, Stats>::size_type BluntQueue<T, Wait, Stats>::push_bulk(std::span<T> values)
+{
+    return push_range(std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
 }
 
-template <typename T>
-bool BluntQueue<T>::try_pop(T& value)
+template <typename T, typename Wait, typename Stats>
+bool BluntQueue<T, Wait, Stats>::try_pop(T& value)
 {
-    std::lock_guard<std::mutex> lock{ mutex_ };
-    if (storage_.empty())
     {
-        return false;
+        const std::unique_lock<std::mutex> lock{ stats_.lock(mutex_, LockSite::Storage) };
+        if (storage_.empty())
+        {
+            return false;
+        }
+
+        // Both moving from and destruction of the top element are expected to be non-throwing,
+        // so the strong exception safety are guaranteed
+        value = std::move(storage_.front());
+        storage_.pop_front();
+        stats_.popped(1);
     }
-
-    // Both moving from and destruction of the top element are expected to be non-throwing,
-    // so the strong exception safety are guaranteed
-    value = std::move(storage_.front());
-    storage_.pop_front();
+    isVacant_.notify_one();
     return true;
 }
 
-template <typename T>
-std::shared_ptr<T> BluntQueue<T>::try_pop()
+template <typename T, typename Wait, typename Stats>
+std::shared_ptr<T> BluntQueue<T, Wait, Stats>::try_pop()
 {
     std::shared_ptr<T> value{};
+    {
+        const std::unique_lock<std::mutex> lock{ stats_.lock(mutex_, LockSite::Storage) };
+        if (storage_.empty())
+        {
+            return value;
+        }
+
+        value.reset(new T{ std::move(storage_.front()) });
+        storage_.pop_front();
+        stats_.popped(1);
+    }
+    isVacant_.notify_one();
+    return value;
+}
 
-    std::lock_guard<std::mutex> lock{ mutex_ };
-    if (storage_.empty())
+template <typename T, typename Wait, typename Stats>
+bool BluntQueue<T, Wait, Stats>::wait_and_pop(T& value)
+{
     {
-        return value;
+        std::unique_lock<std::mutex> lock{ wait_for_front() };
+        if (storage_.empty())
+        {
+            return false;
+        }
+
+        value = std::move(storage_.front());
+        storage_.pop_front();
+        stats_.popped(1);
     }
+    isVacant_.notify_one();
+    return true;
+}
 
-    value.reset(new T{ std::move(storage_.front()) });
-    storage_.pop_front();
+template <typename T, typename Wait, typename Stats>
+std::shared_ptr<T> BluntQueue<T, Wait, Stats>::wait_and_pop()
+{
+    std::shared_ptr<T> value{};
+    {
+        std::unique_lock<std::mutex> lock{ wait_for_front() };
+        if (storage_.empty())
+        {
+            return value;
+        }
+
+        value.reset(new T{ std::move(storage_.front()) });
+        storage_.pop_front();
+        stats_.popped(1);
+    }
+    isVacant_.notify_one();
     return value;
 }
 
-template <typename T>
-bool BluntQueue<T>::wait_and_pop(T& value)
+template <typename T, typename Wait, typename Stats>
+template <typename OutputIt>
+typename BluntQueue<T, Wait, Stats>::size_type BluntQueue<T, Wait, Stats>::try_pop_bulk(OutputIt out, size_type maxCount)
 {
-    std::unique_lock<std::mutex> lock{ mutex_ };
-    isPopulated_.wait(lock, [this]() { return !storage_.empty(); });
+    size_type count{ 0 };
+    {
+        const std::unique_lock<std::mutex> lock{ stats_.lock(mutex_, LockSite::Storage) };
+        count = move_front(out, maxCount);
+    }
+    notify(isVacant_, count);
+    return count;
+}
 
-    value = std::move(storage_.front());
-    storage_.pop_front();
-    return true;
+template <typename T, typename Wait, typename Stats>
+template <typename OutputIt>
+typename BluntQueue<T, Wait, Stats>::size_type BluntQueue<T, Wait, Stats>::wait_and_pop_bulk(OutputIt out, size_type maxCount)
+{
+    size_type count{ 0 };
+    {
+        std::unique_lock<std::mutex> lock{ wait_for_front() };
+        count = move_front(out, maxCount);
+    }
+    notify(isVacant_, count);
+    return count;
 }
 
-template <typename T>
-std::shared_ptr<T> BluntQueue<T>::wait_and_pop()
+template <typename T, typename Wait, typename Stats>
+template <typename Executor>
+typename BluntQueue<T, Wait, Stats>::template PopAwaitable<Executor> BluntQueue<T, Wait, Stats>::async_pop(Executor executor)
 {
-    std::shared_ptr<T> value{};
+    return PopAwaitable<Executor>{ *this, std::move(executor) };
+}
 
-    std::unique_lock<std::mutex> lock{ mutex_ };
-    isPopulated_.wait(lock, [this]() { return !storage_.empty(); });
+template <typename T, typename Wait, typename Stats>
+void BluntQueue<T, Wait, Stats>::close()
+{
+    AsyncWaiter* served{ nullptr };
+    {
+        const std::unique_lock<std::mutex> lock{ stats_.lock(mutex_, LockSite::Storage) };
+        closed_ = true;
+        served = serve_waiters();
+    }
+    resume_waiters(served);
+    isPopulated_.notify_all();
+    isVacant_.notify_all();
+}
 
-    value.reset(new T{ std::move(storage_.front()) });
-    storage_.pop_front();
-    return value;
+template <typename T, typename Wait, typename Stats>
+bool BluntQueue<T, Wait, Stats>::closed() const
+{
+    const std::unique_lock<std::mutex> lock{ stats_.lock(mutex_, LockSite::Storage) };
+    return closed_;
 }
 
-template <typename T>
-bool BluntQueue<T>::empty() const
+template <typename T, typename Wait, typename Stats>
+bool BluntQueue<T, Wait, Stats>::empty() const
 {
-    std::lock_guard<std::mutex> lock{ mutex_ };
+    const std::unique_lock<std::mutex> lock{ stats_.lock(mutex_, LockSite::Storage) };
     return storage_.empty();
 }
 
-template <typename T>
-typename BluntQueue<T>::size_type BluntQueue<T>::size() const
+template <typename T, typename Wait, typename Stats>
+typename BluntQueue<T, Wait, Stats>::size_type BluntQueue<T, Wait, Stats>::size() const
 {
-    std::lock_guard<std::mutex> lock{ mutex_ };
+    const std::unique_lock<std::mutex> lock{ stats_.lock(mutex_, LockSite::Storage) };
     return storage_.size();
 }
 
-template <typename T>
-void BluntQueue<T>::swap(BluntQueue& other)
+template <typename T, typename Wait, typename Stats>
+typename BluntQueue<T, Wait, Stats>::size_type BluntQueue<T, Wait, Stats>::capacity() const
+{
+    const std::unique_lock<std::mutex> lock{ stats_.lock(mutex_, LockSite::Storage) };
+    return capacity_;
+}
+
+template <typename T, typename Wait, typename Stats>
+const Stats& BluntQueue<T, Wait, Stats>::stats() const noexcept
+{
+    return stats_;
+}
+
+template <typename T, typename Wait, typename Stats>
+template <typename... Args>
+bool BluntQueue<T, Wait, Stats>::lock_emplace_back(Args&&... args)
+{
+    AsyncWaiter* served{ nullptr };
+    {
+        std::unique_lock<std::mutex> lock{ stats_.lock(mutex_, LockSite::Storage) };
+        stats_.wait(isVacant_, lock, [this]() { return closed_ || storage_.size() < capacity_; },
+            WaitSite::Push);
+        if (closed_)
+        {
+            return false;
+        }
+
+        storage_.emplace_back(std::forward<Args>(args)...);
+        stats_.pushed(1);
+        served = serve_waiters();
+    }
+    resume_waiters(served);
+    isPopulated_.notify_one();
+    return true;
+}
+
+template <typename T, typename Wait, typename Stats>
+template <typename U>
+bool BluntQueue<T, Wait, Stats>::lock_try_push(U&& value)
+{
+    AsyncWaiter* served{ nullptr };
+    {
+        const std::unique_lock<std::mutex> lock{ stats_.lock(mutex_, LockSite::Storage) };
+        if (closed_ || storage_.size() >= capacity_)
+        {
+            return false;
+        }
+
+        storage_.push_back(std::forward<U>(value));
+        stats_.pushed(1);
+        served = serve_waiters();
+    }
+    resume_waiters(served);
+    isPopulated_.notify_one();
+    return true;
+}
+
+template <typename T, typename Wait, typename Stats>
+std::unique_lock<std::mutex> BluntQueue<T, Wait, Stats>::wait_for_front()
+{
+    std::unique_lock<std::mutex> lock{ stats_.lock(mutex_, LockSite::Storage) };
+    stats_.wait(isPopulated_, lock, [this]() { return closed_ || !storage_.empty(); }, WaitSite::Pop);
+    // Transfer the lock to the caller to handle the rest of a critical section
+    return lock;
+}
+
+template <typename T, typename Wait, typename Stats>
+template <typename OutputIt>
+typename BluntQueue<T, Wait, Stats>::size_type BluntQueue<T, Wait, Stats>::move_front(OutputIt out, size_type maxCount)
+{
+    const size_type count{ std::min(maxCount, storage_.size()) };
+    const auto last{ storage_.begin() + count };
+    std::move(storage_.begin(), last, out);
+    storage_.erase(storage_.begin(), last);
+    stats_.popped(count);
+    return count;
+}
+
+template <typename T, typename Wait, typename Stats>
+bool BluntQueue<T, Wait, Stats>::suspend_pop(AsyncWaiter& waiter)
+{
+    {
+        const std::unique_lock<std::mutex> lock{ stats_.lock(mutex_, LockSite::Storage) };
+        if (storage_.empty() && !closed_)
+        {
+            waiter.next_ = nullptr;
+            (waitersTail_ == nullptr ? waitersHead_ : waitersTail_->next_) = &waiter;
+            waitersTail_ = &waiter;
+            return true;
+        }
+
+        if (!storage_.empty())
+        {
+            waiter.value_.emplace(std::move(storage_.front()));
+            storage_.pop_front();
+            stats_.popped(1);
+        }
+    }
+    isVacant_.notify_one();
+    return false;
+}
+
+template <typename T, typename Wait, typename Stats>
+typename BluntQueue<T, Wait, Stats>::AsyncWaiter* BluntQueue<T, Wait, Stats>::serve_waiters()
+{
+    AsyncWaiter* served{ nullptr };
+    AsyncWaiter** last{ &served };
+    while (waitersHead_ != nullptr && (closed_ || !storage_.empty()))
+    {
+        AsyncWaiter* waiter{ waitersHead_ };
+        waitersHead_ = waiter->next_;
+        if (waitersHead_ == nullptr)
+        {
+            waitersTail_ = nullptr;
+        }
+
+        if (!storage_.empty())
+        {
+            waiter->value_.emplace(std::move(storage_.front()));
+            storage_.pop_front();
+            stats_.popped(1);
+        }
+        waiter->next_ = nullptr;
+        *last = waiter;
+        last = &waiter->next_;
+    }
+    return served;
+}
+
+template <typename T, typename Wait, typename Stats>
+void BluntQueue<T, Wait, Stats>::resume_waiters(AsyncWaiter* served)
+{
+    while (served != nullptr)
+    {
+        // A resumed waiter might be gone right away, so the link is read beforehand
+        AsyncWaiter* next{ served->next_ };
+        served->resume_(*served);
+        served = next;
+    }
+}
+
+template <typename T, typename Wait, typename Stats>
+void BluntQueue<T, Wait, Stats>::notify(Wait& condition, size_type count)
+{
+    // A single element is good for a single waiter, whereas a batch is worth waking everyone
+    if (count == 1)
+    {
+        condition.notify_one();
+    }
+    else if (count > 1)
+    {
+        condition.notify_all();
+    }
+}
+
+template <typename T, typename Wait, typename Stats>
+void BluntQueue<T, Wait, Stats>::swap(BluntQueue& other)
 {
+    AsyncWaiter* served{ nullptr };
+    AsyncWaiter* otherServed{ nullptr };
     {
         std::scoped_lock<std::mutex, std::mutex> lock{ mutex_, other.mutex_ };
         storage_.swap(other.storage_);
+        std::swap(capacity_, other.capacity_);
+        served = serve_waiters();
+        otherServed = other.serve_waiters();
     }
+    resume_waiters(served);
+    resume_waiters(otherServed);
     isPopulated_.notify_one();
     other.isPopulated_.notify_one();
+    isVacant_.notify_all();
+    other.isVacant_.notify_all();
 }
\ No newline at end of file
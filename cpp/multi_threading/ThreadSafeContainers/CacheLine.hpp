@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cstddef>
+
+// Assume the most widespread cache line size, since std::hardware_destructive_interference_size
+// is neither universally available nor stable across compiler flags
+inline constexpr std::size_t kCacheLineSize{ 64 };
@@ -0,0 +1,567 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <initializer_list>
+#include <iterator>
+#include <span>
+#include <utility>
+
+#include "CacheLine.hpp"
+#include "WaitPolicies.hpp"
+
+// An unrolled counterpart of FineQueue, which keeps the head and the tail under separate locks,
+// but stores elements inline within cache line aligned chunks of slots instead of a node per element.
+// Small elements are thus pushed and popped without pointer chasing or an allocation per element,
+// while an atomic counter of elements makes size() and empty() constant and free of locks.
+//
+// A producer constructs an element at the tail under tailMutex_ first and counts it afterwards,
+// so a consumer, which observes a positive count under headMutex_, finds a constructed element at the head
+template <typename T, std::size_t ChunkSize = 32, typename Wait = BlockWait>
+class ChunkedQueue
+{
+    static_assert(ChunkSize > 0, "Expecting at least one slot per chunk");
+
+public:
+    using size_type = std::size_t;
+
+    ChunkedQueue();
+    ChunkedQueue(std::initializer_list<T> list);
+
+    ChunkedQueue(const ChunkedQueue& other);
+    ChunkedQueue(ChunkedQueue&& other) noexcept;
+
+    ChunkedQueue& operator=(const ChunkedQueue& other);
+    ChunkedQueue& operator=(ChunkedQueue&& other) noexcept;
+
+    ~ChunkedQueue() noexcept;
+
+    void push(T value);
+
+    template <typename... Args>
+    void emplace(Args&&... args);
+
+    // Pushing batches under a single lock, which consumers observe at once
+    template <typename InputIt>
+    size_type push_range(InputIt first, InputIt last);
+    size_type push_bulk(std::span<T> values);
+
+    std::shared_ptr<T> try_pop();
+    bool try_pop(T& value);
+
+    std::shared_ptr<T> wait_and_pop();
+    void wait_and_pop(T& value);
+
+    template <typename OutputIt>
+    size_type try_pop_bulk(OutputIt out, size_type maxCount);
+    template <typename OutputIt>
+    size_type wait_and_pop_bulk(OutputIt out, size_type maxCount);
+
+    // Neither of them takes a lock, so the result is merely a snapshot under concurrent modifications
+    size_type size() const noexcept;
+    bool empty() const noexcept;
+
+    void swap(ChunkedQueue& other) noexcept;
+
+    template <typename U, std::size_t N, typename W>
+    friend bool operator==(const ChunkedQueue<U, N, W>& one, const ChunkedQueue<U, N, W>& other);
+
+private:
+
+    // Raw storage for an element, which is constructed on push and destroyed on pop
+    struct Slot
+    {
+        alignas(T) unsigned char bytes_[sizeof(T)];
+    };
+
+    struct alignas(kCacheLineSize) Chunk
+    {
+        Slot slots_[ChunkSize];
+        std::unique_ptr<Chunk> next_{};
+    };
+
+    // Walks counted elements from the head onwards, while the head is locked
+    struct Cursor
+    {
+        const T& next() noexcept;
+
+        const Chunk* chunk_;
+        size_type index_;
+    };
+
+    static T* element(Chunk* chunk, size_type index) noexcept;
+    static const T* element(const Chunk* chunk, size_type index) noexcept;
+
+    // Constructs an element at the tail under a held tailMutex_ without counting it
+    template <typename... Args>
+    void emplace_back(Args&&... args);
+    template <typename... Args>
+    void lock_emplace_back(Args&&... args);
+
+    // Chunks are left behind lazily on the first access beyond their end,
+    // since the next chunk might not be linked yet, when the last slot of the current one is popped
+    T& front() noexcept;
+    void discard_front(T& front) noexcept;
+    std::unique_lock<std::mutex> wait_for_front();
+    template <typename OutputIt>
+    size_type move_front(OutputIt out, size_type maxCount);
+
+    // A single exhausted chunk is kept aside by consumers for the next producer to avoid allocator round trips
+    std::unique_ptr<Chunk> acquire_chunk();
+    void recycle_chunk(std::unique_ptr<Chunk> chunk) noexcept;
+
+    void traverse_push(const ChunkedQueue& other);
+    Cursor cursor() const noexcept;
+    void notify(size_type count);
+    void release() noexcept;
+
+    // Consumers and producers contend on separate cache lines
+    alignas(kCacheLineSize) mutable std::mutex headMutex_;
+    std::unique_ptr<Chunk> head_;
+    size_type headIndex_;
+
+    alignas(kCacheLineSize) mutable std::mutex tailMutex_;
+    Chunk* tail_;
+    size_type tailIndex_;
+
+    alignas(kCacheLineSize) std::atomic<size_type> size_;
+    std::atomic<Chunk*> spare_;
+
+    Wait isPoppable_;
+
+};
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+ChunkedQueue<T, ChunkSize, Wait>::ChunkedQueue() :
+    headMutex_{},
+    head_{ std::make_unique_for_overwrite<Chunk>() },
+    headIndex_{ 0 },
+    tailMutex_{},
+    tail_{ head_.get() },
+    tailIndex_{ 0 },
+    size_{ 0 },
+    spare_{ nullptr },
+    isPoppable_{}
+{
+    // Empty
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+ChunkedQueue<T, ChunkSize, Wait>::ChunkedQueue(std::initializer_list<T> list) :
+    ChunkedQueue()
+{
+    for (const T& value : list)
+    {
+        emplace_back(value);
+        size_.fetch_add(1);
+    }
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+ChunkedQueue<T, ChunkSize, Wait>::ChunkedQueue(const ChunkedQueue& other) :
+    ChunkedQueue()
+{
+    traverse_push(other);
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+ChunkedQueue<T, ChunkSize, Wait>::ChunkedQueue(ChunkedQueue&& other) noexcept :
+    headMutex_{},
+    head_{ nullptr },
+    headIndex_{ 0 },
+    tailMutex_{},
+    tail_{ nullptr },
+    tailIndex_{ 0 },
+    size_{ 0 },
+    spare_{ nullptr },
+    isPoppable_{}
+{
+    // The source is left without even a chunk, which is only fit for destruction or assignment
+    std::scoped_lock<std::mutex, std::mutex> lock{ other.headMutex_, other.tailMutex_ };
+    head_ = std::move(other.head_);
+    headIndex_ = std::exchange(other.headIndex_, 0);
+    tail_ = std::exchange(other.tail_, nullptr);
+    tailIndex_ = std::exchange(other.tailIndex_, 0);
+    size_.store(other.size_.exchange(0));
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+ChunkedQueue<T, ChunkSize, Wait>& ChunkedQueue<T, ChunkSize, Wait>::operator=(const ChunkedQueue& other)
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    // Clone elements of the source queue to provide the strong exception safety for the content
+    ChunkedQueue copy{ other };
+    swap(copy);
+    return *this;
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+ChunkedQueue<T, ChunkSize, Wait>& ChunkedQueue<T, ChunkSize, Wait>::operator=(ChunkedQueue&& other) noexcept
+{
+    swap(other);
+    return *this;
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+ChunkedQueue<T, ChunkSize, Wait>::~ChunkedQueue() noexcept
+{
+    release();
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+void ChunkedQueue<T, ChunkSize, Wait>::push(T value)
+{
+    lock_emplace_back(std::move(value));
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+template <typename... Args>
+void ChunkedQueue<T, ChunkSize, Wait>::emplace(Args&&... args)
+{
+    lock_emplace_back(std::forward<Args>(args)...);
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+template <typename InputIt>
+typename ChunkedQueue<T, ChunkSize, Wait>::size_type ChunkedQueue<T, ChunkSize, Wait>::push_range(InputIt first, InputIt last)
+{
+    size_type count{ 0 };
+    {
+        std::lock_guard<std::mutex> lock{ tailMutex_ };
+        try
+        {
+            for (; first != last; ++first, ++count)
+            {
+                emplace_back(*first);
+            }
+        }
+        catch (...)
+        {
+            // Elements constructed so far are in place already, so hand them over nevertheless
+            size_.fetch_add(count);
+            notify(count);
+            throw;
+        }
+        size_.fetch_add(count);
+    }
+
+    notify(count);
+    return count;
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+typename ChunkedQueue<T, ChunkSize, Wait>::size_type ChunkedQueue<T, ChunkSize, Wait>::push_bulk(std::span<T> values)
+{
+    return push_range(std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+std::shared_ptr<T> ChunkedQueue<T, ChunkSize, Wait>::try_pop()
+{
+    std::lock_guard<std::mutex> lock{ headMutex_ };
+    if (size_.load() == 0)
+    {
+        return std::shared_ptr<T>{};
+    }
+
+    T& head{ front() };
+    std::shared_ptr<T> data{ std::make_shared<T>(std::move(head)) };
+    discard_front(head);
+    size_.fetch_sub(1);
+    return data;
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+bool ChunkedQueue<T, ChunkSize, Wait>::try_pop(T& value)
+{
+    std::lock_guard<std::mutex> lock{ headMutex_ };
+    if (size_.load() == 0)
+    {
+        return false;
+    }
+
+    T& head{ front() };
+    value = std::move(head);
+    discard_front(head);
+    size_.fetch_sub(1);
+    return true;
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+std::shared_ptr<T> ChunkedQueue<T, ChunkSize, Wait>::wait_and_pop()
+{
+    std::unique_lock<std::mutex> lock{ wait_for_front() };
+    T& head{ front() };
+    std::shared_ptr<T> data{ std::make_shared<T>(std::move(head)) };
+    discard_front(head);
+    size_.fetch_sub(1);
+    return data;
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+void ChunkedQueue<T, ChunkSize, Wait>::wait_and_pop(T& value)
+{
+    std::unique_lock<std::mutex> lock{ wait_for_front() };
+    T& head{ front() };
+    value = std::move(head);
+    discard_front(head);
+    size_.fetch_sub(1);
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+template <typename OutputIt>
+typename ChunkedQueue<T, ChunkSize, Wait>::size_type ChunkedQueue<T, ChunkSize, Wait>::try_pop_bulk(OutputIt out, size_type maxCount)
+{
+    std::lock_guard<std::mutex> lock{ headMutex_ };
+    return move_front(out, maxCount);
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+template <typename OutputIt>
+typename ChunkedQueue<T, ChunkSize, Wait>::size_type ChunkedQueue<T, ChunkSize, Wait>::wait_and_pop_bulk(OutputIt out, size_type maxCount)
+{
+    std::unique_lock<std::mutex> lock{ wait_for_front() };
+    return move_front(out, maxCount);
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+typename ChunkedQueue<T, ChunkSize, Wait>::size_type ChunkedQueue<T, ChunkSize, Wait>::size() const noexcept
+{
+    return size_.load(std::memory_order_relaxed);
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+bool ChunkedQueue<T, ChunkSize, Wait>::empty() const noexcept
+{
+    return size() == 0;
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+void ChunkedQueue<T, ChunkSize, Wait>::swap(ChunkedQueue& other) noexcept
+{
+    {
+        // Counters change only under one of the locks, so they are stable, once all of them are taken
+        std::scoped_lock<std::mutex, std::mutex, std::mutex, std::mutex> lock{
+            headMutex_, tailMutex_, other.headMutex_, other.tailMutex_ };
+        std::swap(head_, other.head_);
+        std::swap(headIndex_, other.headIndex_);
+        std::swap(tail_, other.tail_);
+        std::swap(tailIndex_, other.tailIndex_);
+        size_.store(other.size_.exchange(size_.load()));
+    }
+
+    // Consumers, which wait for any of the queues, should have a look at a new content
+    isPoppable_.notify_all();
+    other.isPoppable_.notify_all();
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+const T& ChunkedQueue<T, ChunkSize, Wait>::Cursor::next() noexcept
+{
+    if (index_ == ChunkSize)
+    {
+        chunk_ = chunk_->next_.get();
+        index_ = 0;
+    }
+    return *element(chunk_, index_++);
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+T* ChunkedQueue<T, ChunkSize, Wait>::element(Chunk* chunk, size_type index) noexcept
+{
+    return std::launder(reinterpret_cast<T*>(chunk->slots_[index].bytes_));
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+const T* ChunkedQueue<T, ChunkSize, Wait>::element(const Chunk* chunk, size_type index) noexcept
+{
+    return std::launder(reinterpret_cast<const T*>(chunk->slots_[index].bytes_));
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+template <typename... Args>
+void ChunkedQueue<T, ChunkSize, Wait>::emplace_back(Args&&... args)
+{
+    if (tailIndex_ == ChunkSize)
+    {
+        std::unique_ptr<Chunk> next{ acquire_chunk() };
+        Chunk* const t{ next.get() };
+        tail_->next_ = std::move(next);
+        tail_ = t;
+        tailIndex_ = 0;
+    }
+
+    // Should the construction throw, the slot stays vacant and uncounted
+    ::new (static_cast<void*>(tail_->slots_[tailIndex_].bytes_)) T(std::forward<Args>(args)...);
+    ++tailIndex_;
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+template <typename... Args>
+void ChunkedQueue<T, ChunkSize, Wait>::lock_emplace_back(Args&&... args)
+{
+    {
+        std::lock_guard<std::mutex> lock{ tailMutex_ };
+        emplace_back(std::forward<Args>(args)...);
+        size_.fetch_add(1);
+    }
+
+    isPoppable_.notify_one();
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+T& ChunkedQueue<T, ChunkSize, Wait>::front() noexcept
+{
+    if (headIndex_ == ChunkSize)
+    {
+        std::unique_ptr<Chunk> exhausted{ std::move(head_) };
+        head_ = std::move(exhausted->next_);
+        headIndex_ = 0;
+        recycle_chunk(std::move(exhausted));
+    }
+    return *element(head_.get(), headIndex_);
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+void ChunkedQueue<T, ChunkSize, Wait>::discard_front(T& front) noexcept
+{
+    front.~T();
+    ++headIndex_;
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+std::unique_lock<std::mutex> ChunkedQueue<T, ChunkSize, Wait>::wait_for_front()
+{
+    std::unique_lock<std::mutex> lock{ headMutex_ };
+    isPoppable_.wait(lock, [this]() { return size_.load() > 0; });
+    // Transfer the lock to the caller to handle the rest of a critical section
+    return lock;
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+template <typename OutputIt>
+typename ChunkedQueue<T, ChunkSize, Wait>::size_type ChunkedQueue<T, ChunkSize, Wait>::move_front(OutputIt out, size_type maxCount)
+{
+    // Elements, which arrive meanwhile, are left for the next time to touch the counter just twice
+    const size_type available{ std::min(maxCount, size_.load()) };
+    size_type count{ 0 };
+    try
+    {
+        for (; count < available; ++count)
+        {
+            T& head{ front() };
+            *out = std::move(head);
+            ++out;
+            discard_front(head);
+        }
+    }
+    catch (...)
+    {
+        size_.fetch_sub(count);
+        throw;
+    }
+
+    size_.fetch_sub(count);
+    return count;
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+std::unique_ptr<typename ChunkedQueue<T, ChunkSize, Wait>::Chunk> ChunkedQueue<T, ChunkSize, Wait>::acquire_chunk()
+{
+    std::unique_ptr<Chunk> chunk{ spare_.exchange(nullptr) };
+    if (!chunk)
+    {
+        // Slots are left uninitialized, since elements are constructed right into them
+        chunk = std::make_unique_for_overwrite<Chunk>();
+    }
+    return chunk;
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+void ChunkedQueue<T, ChunkSize, Wait>::recycle_chunk(std::unique_ptr<Chunk> chunk) noexcept
+{
+    // The previous spare, if producers haven't taken it yet, is not worth keeping
+    delete spare_.exchange(chunk.release());
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+void ChunkedQueue<T, ChunkSize, Wait>::traverse_push(const ChunkedQueue& other)
+{
+    // Allow the source queue to be extended (but not shrunk) at other threads, if any
+    std::lock_guard<std::mutex> lock{ other.headMutex_ };
+    Cursor source{ other.cursor() };
+    for (size_type n{ other.size_.load() }; n > 0; --n)
+    {
+        emplace_back(source.next());
+        size_.fetch_add(1);
+    }
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+typename ChunkedQueue<T, ChunkSize, Wait>::Cursor ChunkedQueue<T, ChunkSize, Wait>::cursor() const noexcept
+{
+    return Cursor{ head_.get(), headIndex_ };
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+void ChunkedQueue<T, ChunkSize, Wait>::notify(size_type count)
+{
+    // A single element is good for a single waiter, whereas a batch is worth waking everyone
+    if (count == 1)
+    {
+        isPoppable_.notify_one();
+    }
+    else if (count > 1)
+    {
+        isPoppable_.notify_all();
+    }
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+void ChunkedQueue<T, ChunkSize, Wait>::release() noexcept
+{
+    for (size_type n{ size_.load() }; n > 0; --n)
+    {
+        discard_front(front());
+    }
+
+    // Release chunks one by one to avoid a recursion as deep as the queue
+    std::unique_ptr<Chunk> chunk{ std::move(head_) };
+    while (chunk)
+    {
+        chunk = std::move(chunk->next_);
+    }
+    delete spare_.load();
+}
+
+template <typename T, std::size_t ChunkSize, typename Wait>
+bool operator==(const ChunkedQueue<T, ChunkSize, Wait>& one, const ChunkedQueue<T, ChunkSize, Wait>& other)
+{
+    std::scoped_lock<std::mutex, std::mutex, std::mutex, std::mutex> lock{
+        one.headMutex_, one.tailMutex_, other.headMutex_, other.tailMutex_ };
+
+    std::size_t n{ one.size_.load() };
+    if (n != other.size_.load())
+    {
+        return false;
+    }
+
+    auto iterOne{ one.cursor() };
+    auto iterOther{ other.cursor() };
+    for (; n > 0; --n)
+    {
+        if (!(iterOne.next() == iterOther.next()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -1,13 +1,30 @@
 #pragma once
 
 #include <cstddef>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <initializer_list>
-#include <condition_variable>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <type_traits>
 #include <utility>
 
-template <typename T>
+#include "CacheLine.hpp"
+#include "QueueStats.hpp"
+#include "WaitPolicies.hpp"
+
+// Storage modes of FineQueue elements:
+// keep every element in a separately allocated shared_ptr, which value pops hand out as is
+struct SharedElements {};
+// keep elements inline within nodes, which are recycled through a free list of the queue,
+// so a steady flow of elements does not touch the allocator at all
+struct PooledElements {};
+
+// Consumers block according to the wait policy,
+// whereas the statistics policy accounts the traffic and the contention, if enabled
+template <typename T, typename Storage = SharedElements, typename Wait = BlockWait, typename Stats = NoStats>
 class FineQueue
 {
 public:
@@ -22,109 +39,162 @@ public:
     FineQueue& operator=(const FineQueue& other);
     FineQueue& operator=(FineQueue&& other) noexcept;
 
-    ~FineQueue() noexcept = default;
+    ~FineQueue() noexcept;
 
     void push(T value);
 
     template <typename... Args>
     void emplace(Args&&... args);
 
+    // Pushing batches with a single acquisition of the tail lock and a single notification of consumers.
+    // The shared mode links a batch up front and splices the chain onto the tail in one step,
+    // while the pooled mode moves elements right into recycled nodes under the lock.
+    // The number of pushed elements is returned
+    template <typename InputIt>
+    size_type push_range(InputIt first, InputIt last);
+    size_type push_bulk(std::span<T> values);
+
+    // In the pooled mode managed pointers are allocated on request, so prefer popping by reference there
     std::shared_ptr<T> try_pop();
     bool try_pop(T& value);
 
     std::shared_ptr<T> wait_and_pop();
     void wait_and_pop(T& value);
 
+    // Popping up to the given number of elements with a single acquisition of the head lock,
+    // returning the number of retrieved ones. A waiting version waits for at least one element
+    template <typename OutputIt>
+    size_type try_pop_bulk(OutputIt out, size_type maxCount);
+    template <typename OutputIt>
+    size_type wait_and_pop_bulk(OutputIt out, size_type maxCount);
+
     size_type size() const;
     bool empty() const;
 
     void swap(FineQueue& other) noexcept;
 
-    template <typename U>
-    friend bool operator==(const FineQueue<U>& one, const FineQueue<U>& other);
+    // Reading counters of the statistics policy, e.g. by stats().snapshot()
+    const Stats& stats() const noexcept;
+
+    template <typename U, typename S, typename W, typename A>
+    friend bool operator==(const FineQueue<U, S, W, A>& one, const FineQueue<U, S, W, A>& other);
 
 private:
 
+    static constexpr bool kPooled{ std::is_same_v<Storage, PooledElements> };
+
     // Maintain tenants at separate nodes to increase opportunity for concurrency
     struct Node
     {
-        std::shared_ptr<T> data_;
+        std::conditional_t<kPooled, std::optional<T>, std::shared_ptr<T>> data_;
         std::unique_ptr<Node> next_;
     };
 
     const Node* get_tail() const;
-    void populate(std::shared_ptr<T> data, std::unique_ptr<Node> next, Node*& tail);
+    static void link(std::unique_ptr<Node> next, Node*& tail);
+    static void populate(std::shared_ptr<T> data, std::unique_ptr<Node> next, Node*& tail);
+    static void populate_copy(const T& value, Node*& tail);
     void lock_push_tail(std::shared_ptr<T> data);
-    void lock_traverse_push(const FineQueue& other, Node*& tail);
+    template <typename... Args>
+    void lock_emplace_tail(Args&&... args);
+    size_type lock_traverse_push(const FineQueue& other, Node*& tail);
 
     std::shared_ptr<T> subscribe_head_data();
     void steal_head_data(T& value);
     std::unique_lock<std::mutex> wait_for_head();
     void pop_head();
+    template <typename OutputIt>
+    size_type steal_head_range(OutputIt out, size_type maxCount);
+    void notify(size_type count);
+
+    // The free list of the pooled mode is a stack linked through next_ of spare nodes.
+    // Nodes are taken from it under tailMutex_ only, so the single popper rules out the ABA problem
+    std::unique_ptr<Node> acquire_node();
+    void recycle_node(std::unique_ptr<Node> node) noexcept;
 
-    std::condition_variable isPoppable_;
+    Wait isPoppable_;
 
-    mutable std::mutex headMutex_;
+    // Consumers and producers contend on separate cache lines
+    alignas(kCacheLineSize) mutable std::mutex headMutex_;
     std::unique_ptr<Node> head_;
 
-    mutable std::mutex tailMutex_;
+    alignas(kCacheLineSize) mutable std::mutex tailMutex_;
     Node* tail_;
 
+    // Both parties touch the free list, so it is kept apart from either of them
+    alignas(kCacheLineSize) std::atomic<Node*> spares_;
+
+    QUEUE_NO_UNIQUE_ADDRESS mutable Stats stats_{};
+
 };
 
-template <typename T>
-FineQueue<T>::FineQueue() :
+template <typename T, typename Storage, typename Wait, typename Stats>
+FineQueue<T, Storage, Wait, Stats>::FineQueue() :
     isPoppable_{},
     headMutex_{},
     head_{ std::make_unique<Node>() },
     tailMutex_{},
-    tail_{ head_.get() }
+    tail_{ head_.get() },
+    spares_{ nullptr }
 {
     // Empty
 }
 
-template <typename T>
-FineQueue<T>::FineQueue(std::initializer_list<T> list) :
+template <typename T, typename Storage, typename Wait, typename Stats>
+FineQueue<T, Storage, Wait, Stats>::FineQueue(std::initializer_list<T> list) :
     isPoppable_{},
     headMutex_{},
     head_{ std::make_unique<Node>() },
     tailMutex_{},
-    tail_{ head_.get() }
+    tail_{ head_.get() },
+    spares_{ nullptr }
 {
-    for (const T value : list)
+    for (const T& value : list)
     {
-        std::shared_ptr<T> data{ std::make_shared<T>(value) };
-        std::unique_ptr<Node> next{ std::make_unique<Node>() };
-        populate(std::move(data), std::move(next), tail_);
+        populate_copy(value, tail_);
     }
+    stats_.pushed(list.size());
 }
 
-template <typename T>
-FineQueue<T>::FineQueue(const FineQueue& other) :
+template <typename T, typename Storage, typename Wait, typename Stats>
+FineQueue<T, Storage, Wait, Stats>::FineQueue(const FineQueue& other) :
     isPoppable_{},
     headMutex_{},
     head_{ std::make_unique<Node>() },
     tailMutex_{},
-    tail_{ head_.get() }
+    tail_{ head_.get() },
+    spares_{ nullptr }
 {
-    lock_traverse_push(other, tail_);
+    stats_.pushed(lock_traverse_push(other, tail_));
 }
 
-template <typename T>
-FineQueue<T>::FineQueue(FineQueue&& other) noexcept :
+template <typename T, typename Storage, typename Wait, typename Stats>
+FineQueue<T, Storage, Wait, Stats>::FineQueue(FineQueue&& other) noexcept :
     isPoppable_{},
     headMutex_{},
     head_{ nullptr },
     tailMutex_{},
-    tail_{ nullptr }
+    tail_{ nullptr },
+    spares_{ nullptr }
 {
     std::scoped_lock<std::mutex, std::mutex> lock{ other.headMutex_, other.tailMutex_ };
     head_ = std::move(other.head_);
     tail_ = std::move(other.tail_);
 }
 
-template <typename T>
-FineQueue<T>& FineQueue<T>::operator=(const FineQueue& other)
+template <typename T, typename Storage, typename Wait, typename Stats>
+FineQueue<T, Storage, Wait, Stats>::~FineQueue() noexcept
+{
+    // Release spare nodes one by one to avoid a recursion as deep as the pool
+    std::unique_ptr<Node> spare{ spares_.load() };
+    while (spare)
+    {
+        spare = std::move(spare->next_);
+    }
+}
+
+template <typename T, typename Storage, typename Wait, typename Stats>
+FineQueue<T, Storage, Wait, Stats>& FineQueue<T, Storage, Wait, Stats>::operator=(const FineQueue& other)
 {
     if (this == &other)
     {
@@ -147,8 +217,8 @@ FineQueue<T>& FineQueue<T>::operator=(const FineQueue& other)
     return *this;
 }
 
-template <typename T>
-FineQueue<T>& FineQueue<T>::operator=(FineQueue&& other) noexcept
+template <typename T, typename Storage, typename Wait, typename Stats>
+FineQueue<T, Storage, Wait, Stats>& FineQueue<T, Storage, Wait, Stats>::operator=(FineQueue&& other) noexcept
 {
     {
         std::scoped_lock<std::mutex, std::mutex, std::mutex, std::mutex> lock{
@@ -161,25 +231,86 @@ FineQueue<T>& FineQueue<T>::operator=(FineQueue&& other) noexcept
     return *this;
 }
 
-template <typename T>
-void FineQueue<T>::push(T value)
+template <typename T, typename Storage, typename Wait, typename Stats>
+void FineQueue<T, Storage, Wait, Stats>::push(T value)
 {
-    std::shared_ptr<T> data{ std::make_shared<T>(std::move(value)) };
-    lock_push_tail(std::move(data));
+    if constexpr (kPooled)
+    {
+        lock_emplace_tail(std::move(value));
+    }
+    else
+    {
+        std::shared_ptr<T> data{ std::make_shared<T>(std::move(value)) };
+        lock_push_tail(std::move(data));
+    }
 }
 
-template <typename T>
+template <typename T, typename Storage, typename Wait, typename Stats>
 template <typename... Args>
-void FineQueue<T>::emplace(Args&&... args)
+void FineQueue<T, Storage, Wait, Stats>::emplace(Args&&... args)
+{
+    if constexpr (kPooled)
+    {
+        lock_emplace_tail(std::forward<Args>(args)...);
+    }
+    else
+    {
+        std::shared_ptr<T> data{ std::make_shared<T>(std::forward<Args>(args)...) };
+        lock_push_tail(std::move(data));
+    }
+}
+
+template <typename T, typename Storage, typename Wait, typename Stats>
+template <typename InputIt>
+typename FineQueue<T, Storage, Wait, Stats>::size_type FineQueue<T, Storage, Wait, Stats>::push_range(InputIt first, InputIt last)
+{
+    size_type count{ 0 };
+    if constexpr (kPooled)
+    {
+        const std::unique_lock<std::mutex> lock{ stats_.lock(tailMutex_, LockSite::Tail) };
+        for (; first != last; ++first, ++count)
+        {
+            std::unique_ptr<Node> next{ acquire_node() };
+            tail_->data_.emplace(*first);
+            link(std::move(next), tail_);
+        }
+        stats_.pushed(count);
+    }
+    else
+    {
+        // The head of a chain just carries the first element over to the current dummy of the queue
+        std::unique_ptr<Node> chain{ std::make_unique<Node>() };
+        Node* chainTail{ chain.get() };
+        for (; first != last; ++first, ++count)
+        {
+            populate(std::make_shared<T>(*first), std::make_unique<Node>(), chainTail);
+        }
+        if (count == 0)
+        {
+            return count;
+        }
+
+        const std::unique_lock<std::mutex> lock{ stats_.lock(tailMutex_, LockSite::Tail) };
+        tail_->data_ = std::move(chain->data_);
+        tail_->next_ = std::move(chain->next_);
+        tail_ = chainTail;
+        stats_.pushed(count);
+    }
+
+    notify(count);
+    return count;
+}
+
+template <typename T, typename Storage, typename Wait, typename Stats>
+typename FineQueue<T, Storage, Wait, Stats>::size_type FineQueue<T, Storage, Wait, Stats>::push_bulk(std::span<T> values)
 {
-    std::shared_ptr<T> data{ std::make_shared<T>(std::forward<Args>(args)...) };
-    lock_push_tail(std::move(data));
+    return push_range(std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
 }
 
-template <typename T>
-std::shared_ptr<T> FineQueue<T>::try_pop()
+template <typename T, typename Storage, typename Wait, typename Stats>
+std::shared_ptr<T> FineQueue<T, Storage, Wait, Stats>::try_pop()
 {
-    std::lock_guard<std::mutex> lock{ headMutex_ };
+    const std::unique_lock<std::mutex> lock{ stats_.lock(headMutex_, LockSite::Head) };
     if (head_.get() == get_tail())
     {
         return std::shared_ptr<T>{};
@@ -190,10 +321,10 @@ std::shared_ptr<T> FineQueue<T>::try_pop()
     return data;
 }
 
-template <typename T>
-bool FineQueue<T>::try_pop(T& value)
+template <typename T, typename Storage, typename Wait, typename Stats>
+bool FineQueue<T, Storage, Wait, Stats>::try_pop(T& value)
 {
-    std::lock_guard<std::mutex> lock{ headMutex_ };
+    const std::unique_lock<std::mutex> lock{ stats_.lock(headMutex_, LockSite::Head) };
     if (head_.get() == get_tail())
     {
         return false;
@@ -204,8 +335,8 @@ bool FineQueue<T>::try_pop(T& value)
     return true;
 }
 
-template <typename T>
-std::shared_ptr<T> FineQueue<T>::wait_and_pop()
+template <typename T, typename Storage, typename Wait, typename Stats>
+std::shared_ptr<T> FineQueue<T, Storage, Wait, Stats>::wait_and_pop()
 {
     std::unique_lock<std::mutex> lock{ wait_for_head() };
     std::shared_ptr<T> data{ subscribe_head_data() };
@@ -213,21 +344,37 @@ std::shared_ptr<T> FineQueue<T>::wait_and_pop()
     return data;
 }
 
-template <typename T>
-void FineQueue<T>::wait_and_pop(T& value)
+template <typename T, typename Storage, typename Wait, typename Stats>
+void FineQueue<T, Storage, Wait, Stats>::wait_and_pop(T& value)
 {
     std::unique_lock<std::mutex> lock{ wait_for_head() };
     steal_head_data(value);
     pop_head();
 }
 
-template <typename T>
-typename FineQueue<T>::size_type FineQueue<T>::size() const
+template <typename T, typename Storage, typename Wait, typename Stats>
+template <typename OutputIt>
+typename FineQueue<T, Storage, Wait, Stats>::size_type FineQueue<T, Storage, Wait, Stats>::try_pop_bulk(OutputIt out, size_type maxCount)
+{
+    const std::unique_lock<std::mutex> lock{ stats_.lock(headMutex_, LockSite::Head) };
+    return steal_head_range(out, maxCount);
+}
+
+template <typename T, typename Storage, typename Wait, typename Stats>
+template <typename OutputIt>
+typename FineQueue<T, Storage, Wait, Stats>::size_type FineQueue<T, Storage, Wait, Stats>::wait_and_pop_bulk(OutputIt out, size_type maxCount)
+{
+    std::unique_lock<std::mutex> lock{ wait_for_head() };
+    return steal_head_range(out, maxCount);
+}
+
+template <typename T, typename Storage, typename Wait, typename Stats>
+typename FineQueue<T, Storage, Wait, Stats>::size_type FineQueue<T, Storage, Wait, Stats>::size() const
 {
     size_type length{ 0 };
 
     // Allow the queue to expand (but not shrink) while computing its length
-    std::lock_guard<std::mutex> lock{ headMutex_ };
+    const std::unique_lock<std::mutex> lock{ stats_.lock(headMutex_, LockSite::Head) };
     for (const Node* i{ head_.get() }; i != get_tail(); i = i->next_.get())
     {
         ++length;
@@ -236,84 +383,210 @@ typename FineQueue<T>::size_type FineQueue<T>::size() const
     return length;
 }
 
-template <typename T>
-bool FineQueue<T>::empty() const
+template <typename T, typename Storage, typename Wait, typename Stats>
+bool FineQueue<T, Storage, Wait, Stats>::empty() const
 {
-    std::lock_guard<std::mutex> lock{ headMutex_ };
+    const std::unique_lock<std::mutex> lock{ stats_.lock(headMutex_, LockSite::Head) };
     return head_.get() == get_tail();
 }
 
-template <typename T>
-const typename FineQueue<T>::Node* FineQueue<T>::get_tail() const
+template <typename T, typename Storage, typename Wait, typename Stats>
+const Stats& FineQueue<T, Storage, Wait, Stats>::stats() const noexcept
 {
-    std::lock_guard<std::mutex> lock{ tailMutex_ };
+    return stats_;
+}
+
+template <typename T, typename Storage, typename Wait, typename Stats>
+const typename FineQueue<T, Storage, Wait, Stats>::Node* FineQueue<T, Storage, Wait, Stats>::get_tail() const
+{
+    const std::unique_lock<std::mutex> lock{ stats_.lock(tailMutex_, LockSite::Tail) };
     return tail_;
 }
 
-template <typename T>
-void FineQueue<T>::populate(std::shared_ptr<T> data, std::unique_ptr<Node> next, Node*& tail)
+template <typename T, typename Storage, typename Wait, typename Stats>
+void FineQueue<T, Storage, Wait, Stats>::link(std::unique_ptr<Node> next, Node*& tail)
 {
-    tail->data_ = std::move(data);
     Node* const t{ next.get() };
     tail->next_ = std::move(next);
     tail = t;
 }
 
-template <typename T>
-void FineQueue<T>::lock_push_tail(std::shared_ptr<T> data)
+template <typename T, typename Storage, typename Wait, typename Stats>
+void FineQueue<T, Storage, Wait, Stats>::populate(std::shared_ptr<T> data, std::unique_ptr<Node> next, Node*& tail)
+{
+    tail->data_ = std::move(data);
+    link(std::move(next), tail);
+}
+
+template <typename T, typename Storage, typename Wait, typename Stats>
+void FineQueue<T, Storage, Wait, Stats>::populate_copy(const T& value, Node*& tail)
+{
+    std::unique_ptr<Node> next{ std::make_unique<Node>() };
+    if constexpr (kPooled)
+    {
+        tail->data_.emplace(value);
+        link(std::move(next), tail);
+    }
+    else
+    {
+        populate(std::make_shared<T>(value), std::move(next), tail);
+    }
+}
+
+template <typename T, typename Storage, typename Wait, typename Stats>
+void FineQueue<T, Storage, Wait, Stats>::lock_push_tail(std::shared_ptr<T> data)
 {
     std::unique_ptr<Node> next{ std::make_unique<Node>() };
     {
-        std::lock_guard<std::mutex> lock{ tailMutex_ };
+        const std::unique_lock<std::mutex> lock{ stats_.lock(tailMutex_, LockSite::Tail) };
         populate(std::move(data), std::move(next), tail_);
+        stats_.pushed(1);
+    }
+
+    isPoppable_.notify_one();
+}
+
+template <typename T, typename Storage, typename Wait, typename Stats>
+template <typename... Args>
+void FineQueue<T, Storage, Wait, Stats>::lock_emplace_tail(Args&&... args)
+{
+    {
+        // The element is constructed right within the current dummy, which is cheaper than
+        // an allocation for movable values, whereas a next dummy is normally a recycled node
+        const std::unique_lock<std::mutex> lock{ stats_.lock(tailMutex_, LockSite::Tail) };
+        std::unique_ptr<Node> next{ acquire_node() };
+        tail_->data_.emplace(std::forward<Args>(args)...);
+        link(std::move(next), tail_);
+        stats_.pushed(1);
     }
 
     isPoppable_.notify_one();
 }
 
-template <typename T>
-void FineQueue<T>::lock_traverse_push(const FineQueue& other, Node*& tail)
+template <typename T, typename Storage, typename Wait, typename Stats>
+typename FineQueue<T, Storage, Wait, Stats>::size_type FineQueue<T, Storage, Wait, Stats>::lock_traverse_push(const FineQueue& other, Node*& tail)
 {
+    size_type count{ 0 };
+
     // Allow the source queue to be extended (but not shrunk) at other threads, if any 
     std::lock_guard<std::mutex> lock{ other.headMutex_ };
-    for (const Node* i{ other.head_.get() }; i != other.get_tail(); i = i->next_.get())
+    for (const Node* i{ other.head_.get() }; i != other.get_tail(); i = i->next_.get(), ++count)
     {
-        std::shared_ptr<T> data{ std::make_shared<T>(*i->data_) };
-        std::unique_ptr<Node> next{ std::make_unique<Node>() };
-        populate(std::move(data), std::move(next), tail);
+        populate_copy(*i->data_, tail);
     }
+
+    return count;
 }
 
-template <typename T>
-std::shared_ptr<T> FineQueue<T>::subscribe_head_data()
+template <typename T, typename Storage, typename Wait, typename Stats>
+std::shared_ptr<T> FineQueue<T, Storage, Wait, Stats>::subscribe_head_data()
 {
-    return head_->data_;
+    if constexpr (kPooled)
+    {
+        return std::make_shared<T>(std::move(*(head_->data_)));
+    }
+    else
+    {
+        return head_->data_;
+    }
 }
 
-template <typename T>
-void FineQueue<T>::steal_head_data(T& value)
+template <typename T, typename Storage, typename Wait, typename Stats>
+void FineQueue<T, Storage, Wait, Stats>::steal_head_data(T& value)
 {
     value = std::move(*(head_->data_));
 }
 
-template <typename T>
-std::unique_lock<std::mutex> FineQueue<T>::wait_for_head()
+template <typename T, typename Storage, typename Wait, typename Stats>
+std::unique_lock<std::mutex> FineQueue<T, Storage, Wait, Stats>::wait_for_head()
 {
-    std::unique_lock<std::mutex> lock{ headMutex_ };
-    isPoppable_.wait(lock, [this]() { return head_.get() != get_tail(); });
+    std::unique_lock<std::mutex> lock{ stats_.lock(headMutex_, LockSite::Head) };
+    stats_.wait(isPoppable_, lock, [this]() { return head_.get() != get_tail(); }, WaitSite::Pop);
     // Transfer the lock to the caller to handle the rest of a critical section
     return lock;
 }
 
-template <typename T>
-void FineQueue<T>::pop_head()
+template <typename T, typename Storage, typename Wait, typename Stats>
+void FineQueue<T, Storage, Wait, Stats>::pop_head()
 {
     std::unique_ptr<Node> oldHead_{ std::move(head_) };
     head_ = std::move(oldHead_->next_);
+    stats_.popped(1);
+    if constexpr (kPooled)
+    {
+        oldHead_->data_.reset();
+        recycle_node(std::move(oldHead_));
+    }
+}
+
+template <typename T, typename Storage, typename Wait, typename Stats>
+template <typename OutputIt>
+typename FineQueue<T, Storage, Wait, Stats>::size_type FineQueue<T, Storage, Wait, Stats>::steal_head_range(OutputIt out, size_type maxCount)
+{
+    // Elements, which arrive meanwhile, are left for the next time to look the tail up just once
+    const Node* const tail{ get_tail() };
+    size_type count{ 0 };
+    for (; count < maxCount && head_.get() != tail; ++count)
+    {
+        *out = std::move(*(head_->data_));
+        ++out;
+        pop_head();
+    }
+    return count;
+}
+
+template <typename T, typename Storage, typename Wait, typename Stats>
+void FineQueue<T, Storage, Wait, Stats>::notify(size_type count)
+{
+    // A single element is good for a single waiter, whereas a batch is worth waking everyone
+    if (count == 1)
+    {
+        isPoppable_.notify_one();
+    }
+    else if (count > 1)
+    {
+        isPoppable_.notify_all();
+    }
+}
+
+template <typename T, typename Storage, typename Wait, typename Stats>
+std::unique_ptr<typename FineQueue<T, Storage, Wait, Stats>::Node> FineQueue<T, Storage, Wait, Stats>::acquire_node()
+{
+    if constexpr (kPooled)
+    {
+        Node* spare{ spares_.load(std::memory_order_acquire) };
+        while (spare != nullptr &&
+            !spares_.compare_exchange_weak(spare, spare->next_.get(), std::memory_order_acquire))
+        {
+            // Retry with a freshly recycled top
+        }
+
+        if (spare != nullptr)
+        {
+            std::unique_ptr<Node> node{ spare };
+            node->next_.release();
+            return node;
+        }
+    }
+
+    return std::make_unique<Node>();
+}
+
+template <typename T, typename Storage, typename Wait, typename Stats>
+void FineQueue<T, Storage, Wait, Stats>::recycle_node(std::unique_ptr<Node> node) noexcept
+{
+    Node* const spare{ node.release() };
+    Node* top{ spares_.load(std::memory_order_relaxed) };
+    do
+    {
+        // The link is owning only formally: a spare is unlinked by release before being reused
+        spare->next_.release();
+        spare->next_.reset(top);
+    } while (!spares_.compare_exchange_weak(top, spare, std::memory_order_release, std::memory_order_relaxed));
 }
 
-template <typename T>
-void FineQueue<T>::swap(FineQueue& other) noexcept
+template <typename T, typename Storage, typename Wait, typename Stats>
+void FineQueue<T, Storage, Wait, Stats>::swap(FineQueue& other) noexcept
 {
     std::scoped_lock<std::mutex, std::mutex, std::mutex, std::mutex> lock{
         headMutex_, tailMutex_, other.headMutex_, other.tailMutex_ };
@@ -321,10 +594,10 @@ void FineQueue<T>::swap(FineQueue& other) noexcept
     std::swap(tail_, other.tail_);
 }
 
-template <typename T>
-bool operator==(const FineQueue<T>& one, const FineQueue<T>& other)
+template <typename T, typename Storage, typename Wait, typename Stats>
+bool operator==(const FineQueue<T, Storage, Wait, Stats>& one, const FineQueue<T, Storage, Wait, Stats>& other)
 {
-    using Node = FineQueue<T>::Node;
+    using Node = typename FineQueue<T, Storage, Wait, Stats>::Node;
 
     std::scoped_lock<std::mutex, std::mutex, std::mutex, std::mutex> lock{
         one.headMutex_, one.tailMutex_, other.headMutex_, other.tailMutex_ };
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "CacheLine.hpp"
+
+// A process-wide domain of hazard pointers, which lets lock-free containers reclaim nodes
+// only after no thread is about to dereference them any more
+class HazardPointers
+{
+public:
+
+    // Number of hazard pointers a single thread might hold at once
+    static constexpr std::size_t kPerThread{ 2 };
+    // Upper bound for threads using the domain simultaneously
+    static constexpr std::size_t kMaxThreads{ 128 };
+
+    HazardPointers() = delete;
+
+    // Publishes a pointer loaded from the source, so that it won't be reclaimed till the slot is cleared.
+    // The load is repeated until the published value is confirmed to be still current
+    template <typename T>
+    static T* protect(std::size_t slot, const std::atomic<T*>& source);
+
+    static void clear(std::size_t slot) noexcept;
+
+    // Hands a node, which is no longer reachable, over to the domain, so that it is deleted later on
+    template <typename T>
+    static void retire(T* pointer);
+
+private:
+
+    struct alignas(kCacheLineSize) Record
+    {
+        std::atomic<bool> owned_{ false };
+        std::atomic<void*> pointers_[kPerThread]{};
+    };
+
+    struct Retired
+    {
+        void* pointer_;
+        void (*deleter_)(void*);
+    };
+
+    // Per-thread state: hazard records claimed by the thread and nodes it has retired
+    struct Local
+    {
+        Local();
+        ~Local();
+
+        Record* record_;
+        std::vector<Retired> retired_;
+    };
+
+    // Nodes left behind by exited threads, which are reclaimed by the next scanning thread
+    struct Orphans
+    {
+        ~Orphans();
+
+        std::mutex mutex_;
+        std::vector<Retired> retired_;
+    };
+
+    // Amortize the cost of scanning all records across many retirements
+    static constexpr std::size_t kScanThreshold{ 2 * kPerThread * kMaxThreads };
+
+    static Record* records() noexcept;
+    static Local& local();
+    static Orphans& orphans();
+    static void scan(std::vector<Retired>& retired);
+
+};
+
+template <typename T>
+T* HazardPointers::protect(std::size_t slot, const std::atomic<T*>& source)
+{
+    std::atomic<void*>& hazard{ local().record_->pointers_[slot] };
+
+    T* pointer{ source.load() };
+    while (true)
+    {
+        hazard.store(pointer);
+        T* const confirmed{ source.load() };
+        if (confirmed == pointer)
+        {
+            return pointer;
+        }
+        pointer = confirmed;
+    }
+}
+
+inline void HazardPointers::clear(std::size_t slot) noexcept
+{
+    local().record_->pointers_[slot].store(nullptr, std::memory_order_release);
+}
+
+template <typename T>
+void HazardPointers::retire(T* pointer)
+{
+    std::vector<Retired>& retired{ local().retired_ };
+    retired.push_back(Retired{ pointer, [](void* p) { delete static_cast<T*>(p); } });
+    if (retired.size() >= kScanThreshold)
+    {
+        scan(retired);
+    }
+}
+
+inline HazardPointers::Record* HazardPointers::records() noexcept
+{
+    static Record records[kMaxThreads]{};
+    return records;
+}
+
+inline HazardPointers::Local& HazardPointers::local()
+{
+    thread_local Local local{};
+    return local;
+}
+
+inline HazardPointers::Orphans& HazardPointers::orphans()
+{
+    static Orphans orphans{};
+    return orphans;
+}
+
+inline void HazardPointers::scan(std::vector<Retired>& retired)
+{
+    // Adopt nodes of exited threads to have them reclaimed eventually
+    {
+        Orphans& pending{ orphans() };
+        std::lock_guard<std::mutex> lock{ pending.mutex_ };
+        retired.insert(retired.end(), pending.retired_.cbegin(), pending.retired_.cend());
+        pending.retired_.clear();
+    }
+
+    std::vector<void*> hazards{};
+    hazards.reserve(kPerThread * kMaxThreads);
+    const Record* const all{ records() };
+    for (std::size_t r{ 0 }; r < kMaxThreads; ++r)
+    {
+        for (const std::atomic<void*>& pointer : all[r].pointers_)
+        {
+            if (void* const hazard{ pointer.load() }; hazard != nullptr)
+            {
+                hazards.push_back(hazard);
+            }
+        }
+    }
+    std::sort(hazards.begin(), hazards.end());
+
+    // Keep nodes, which are still in use, for the next scan
+    const auto survivors{ std::partition(retired.begin(), retired.end(), [&hazards](const Retired& r)
+    {
+        return std::binary_search(hazards.cbegin(), hazards.cend(), r.pointer_);
+    }) };
+    for (auto r{ survivors }; r != retired.end(); ++r)
+    {
+        r->deleter_(r->pointer_);
+    }
+    retired.erase(survivors, retired.end());
+}
+
+inline HazardPointers::Local::Local() :
+    record_{ nullptr },
+    retired_{}
+{
+    Record* const all{ records() };
+    for (std::size_t r{ 0 }; r < kMaxThreads; ++r)
+    {
+        bool expected{ false };
+        if (all[r].owned_.compare_exchange_strong(expected, true))
+        {
+            record_ = &all[r];
+            return;
+        }
+    }
+    throw std::length_error{ "Exhausted hazard pointer records" };
+}
+
+inline HazardPointers::Local::~Local()
+{
+    for (std::atomic<void*>& pointer : record_->pointers_)
+    {
+        pointer.store(nullptr);
+    }
+    scan(retired_);
+
+    if (!retired_.empty())
+    {
+        Orphans& pending{ orphans() };
+        std::lock_guard<std::mutex> lock{ pending.mutex_ };
+        pending.retired_.insert(pending.retired_.end(), retired_.cbegin(), retired_.cend());
+    }
+    record_->owned_.store(false, std::memory_order_release);
+}
+
+inline HazardPointers::Orphans::~Orphans()
+{
+    // No thread could hold a hazard pointer during static destruction
+    for (const Retired& r : retired_)
+    {
+        r.deleter_(r.pointer_);
+    }
+}
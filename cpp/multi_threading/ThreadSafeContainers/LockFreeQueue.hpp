@@ -0,0 +1,365 @@
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <initializer_list>
+#include <utility>
+
+#include "CacheLine.hpp"
+#include "HazardPointers.hpp"
+#include "WaitPolicies.hpp"
+
+// A lock-free counterpart of FineQueue, which keeps the same dummy-node list,
+// but links nodes at the tail and unlinks them at the head by compare-and-swap (Michael & Scott).
+// Unlinked nodes are reclaimed through hazard pointers.
+//
+// Element operations are safe to call concurrently. Operations on whole queues
+// (copying, moving, swapping and comparison) tolerate concurrent pushes to a source,
+// but expect no concurrent pops from it and no concurrent access to a target at all.
+// Blocking pops park according to the wait policy
+template <typename T, typename Wait = BlockWait>
+class LockFreeQueue
+{
+public:
+    using size_type = std::size_t;
+
+    LockFreeQueue();
+    LockFreeQueue(std::initializer_list<T> list);
+
+    LockFreeQueue(const LockFreeQueue& other);
+    LockFreeQueue(LockFreeQueue&& other) noexcept;
+
+    LockFreeQueue& operator=(const LockFreeQueue& other);
+    LockFreeQueue& operator=(LockFreeQueue&& other) noexcept;
+
+    ~LockFreeQueue() noexcept;
+
+    void push(T value);
+
+    template <typename... Args>
+    void emplace(Args&&... args);
+
+    std::shared_ptr<T> try_pop();
+    bool try_pop(T& value);
+
+    std::shared_ptr<T> wait_and_pop();
+    void wait_and_pop(T& value);
+
+    // The size is tracked by a counter, so it is exact only in absence of concurrent modifications
+    size_type size() const;
+    bool empty() const;
+
+    void swap(LockFreeQueue& other) noexcept;
+
+    template <typename U, typename W>
+    friend bool operator==(const LockFreeQueue<U, W>& one, const LockFreeQueue<U, W>& other);
+
+private:
+
+    // The head node is always a dummy, whose value has already been taken by a consumer.
+    // A value is written before its node is published and never changes afterwards
+    struct Node
+    {
+        T* data_;
+        std::atomic<Node*> next_;
+    };
+
+    // Hazard pointer slots used by operations of the queue
+    static constexpr std::size_t kFirstHazard{ 0 };
+    static constexpr std::size_t kSecondHazard{ 1 };
+
+    void link_tail(std::unique_ptr<T> data);
+    std::unique_ptr<T> unlink_head();
+    std::unique_ptr<T> wait_for_head();
+
+    void traverse_push(const LockFreeQueue& other);
+    void release() noexcept;
+
+    alignas(kCacheLineSize) std::atomic<Node*> head_;
+    alignas(kCacheLineSize) std::atomic<Node*> tail_;
+    alignas(kCacheLineSize) std::atomic<std::ptrdiff_t> size_;
+
+    // Availability of elements is checked by atomic operations, so consumers wait without a lock
+    alignas(kCacheLineSize) Wait isPoppable_;
+
+};
+
+template <typename T, typename Wait>
+LockFreeQueue<T, Wait>::LockFreeQueue() :
+    head_{ new Node{ nullptr, nullptr } },
+    tail_{ head_.load() },
+    size_{ 0 },
+    isPoppable_{}
+{
+    // Empty
+}
+
+template <typename T, typename Wait>
+LockFreeQueue<T, Wait>::LockFreeQueue(std::initializer_list<T> list) :
+    LockFreeQueue()
+{
+    for (const T& value : list)
+    {
+        link_tail(std::make_unique<T>(value));
+    }
+}
+
+template <typename T, typename Wait>
+LockFreeQueue<T, Wait>::LockFreeQueue(const LockFreeQueue& other) :
+    LockFreeQueue()
+{
+    traverse_push(other);
+}
+
+template <typename T, typename Wait>
+LockFreeQueue<T, Wait>::LockFreeQueue(LockFreeQueue&& other) noexcept :
+    head_{ other.head_.exchange(nullptr) },
+    tail_{ other.tail_.exchange(nullptr) },
+    size_{ other.size_.exchange(0) },
+    isPoppable_{}
+{
+    // The source is left without even a dummy node, which is only fit for destruction or assignment
+}
+
+template <typename T, typename Wait>
+LockFreeQueue<T, Wait>& LockFreeQueue<T, Wait>::operator=(const LockFreeQueue& other)
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    // Clone elements of the source queue to provide the strong exception safety for the content
+    LockFreeQueue copy{ other };
+    swap(copy);
+    return *this;
+}
+
+template <typename T, typename Wait>
+LockFreeQueue<T, Wait>& LockFreeQueue<T, Wait>::operator=(LockFreeQueue&& other) noexcept
+{
+    swap(other);
+    return *this;
+}
+
+template <typename T, typename Wait>
+LockFreeQueue<T, Wait>::~LockFreeQueue() noexcept
+{
+    release();
+}
+
+template <typename T, typename Wait>
+void LockFreeQueue<T, Wait>::push(T value)
+{
+    link_tail(std::make_unique<T>(std::move(value)));
+}
+
+template <typename T, typename Wait>
+template <typename... Args>
+void LockFreeQueue<T, Wait>::emplace(Args&&... args)
+{
+    link_tail(std::make_unique<T>(std::forward<Args>(args)...));
+}
+
+template <typename T, typename Wait>
+std::shared_ptr<T> LockFreeQueue<T, Wait>::try_pop()
+{
+    return std::shared_ptr<T>{ unlink_head() };
+}
+
+template <typename T, typename Wait>
+bool LockFreeQueue<T, Wait>::try_pop(T& value)
+{
+    const std::unique_ptr<T> data{ unlink_head() };
+    if (!data)
+    {
+        return false;
+    }
+
+    value = std::move(*data);
+    return true;
+}
+
+template <typename T, typename Wait>
+std::shared_ptr<T> LockFreeQueue<T, Wait>::wait_and_pop()
+{
+    return std::shared_ptr<T>{ wait_for_head() };
+}
+
+template <typename T, typename Wait>
+void LockFreeQueue<T, Wait>::wait_and_pop(T& value)
+{
+    const std::unique_ptr<T> data{ wait_for_head() };
+    value = std::move(*data);
+}
+
+template <typename T, typename Wait>
+typename LockFreeQueue<T, Wait>::size_type LockFreeQueue<T, Wait>::size() const
+{
+    // A pop might be accounted before the matching push, so clamp a transiently negative counter
+    const std::ptrdiff_t size{ size_.load(std::memory_order_relaxed) };
+    return size > 0 ? static_cast<size_type>(size) : 0;
+}
+
+template <typename T, typename Wait>
+bool LockFreeQueue<T, Wait>::empty() const
+{
+    const Node* const head{ HazardPointers::protect(kFirstHazard, head_) };
+    const bool empty{ head->next_.load() == nullptr };
+    HazardPointers::clear(kFirstHazard);
+    return empty;
+}
+
+template <typename T, typename Wait>
+void LockFreeQueue<T, Wait>::swap(LockFreeQueue& other) noexcept
+{
+    head_.store(other.head_.exchange(head_.load()));
+    tail_.store(other.tail_.exchange(tail_.load()));
+    size_.store(other.size_.exchange(size_.load()));
+
+    // Consumers, which wait for any of the queues, should have a look at a new content
+    isPoppable_.notify_all();
+    other.isPoppable_.notify_all();
+}
+
+template <typename T, typename Wait>
+void LockFreeQueue<T, Wait>::link_tail(std::unique_ptr<T> data)
+{
+    Node* const node{ new Node{ data.get(), nullptr } };
+    data.release();
+
+    while (true)
+    {
+        Node* tail{ HazardPointers::protect(kFirstHazard, tail_) };
+        Node* next{ tail->next_.load() };
+        if (next != nullptr)
+        {
+            // Help a lagging producer to swing the tail, before trying to append again
+            tail_.compare_exchange_weak(tail, next);
+            continue;
+        }
+
+        if (tail->next_.compare_exchange_weak(next, node))
+        {
+            // Failing to swing the tail is fine, since someone else has helped already
+            tail_.compare_exchange_strong(tail, node);
+            break;
+        }
+    }
+    HazardPointers::clear(kFirstHazard);
+    size_.fetch_add(1, std::memory_order_relaxed);
+    isPoppable_.notify_one();
+}
+
+template <typename T, typename Wait>
+std::unique_ptr<T> LockFreeQueue<T, Wait>::unlink_head()
+{
+    std::unique_ptr<T> data{};
+    while (true)
+    {
+        Node* head{ HazardPointers::protect(kFirstHazard, head_) };
+        Node* const next{ HazardPointers::protect(kSecondHazard, head->next_) };
+        if (head != head_.load())
+        {
+            // The head has been unlinked meanwhile, so its successor might be gone as well
+            continue;
+        }
+
+        if (next == nullptr)
+        {
+            break;
+        }
+
+        Node* tail{ tail_.load() };
+        if (head == tail)
+        {
+            // Don't let the head overtake a lagging tail
+            tail_.compare_exchange_weak(tail, next);
+            continue;
+        }
+
+        // The successor becomes a new dummy, while its value goes to the winning consumer
+        T* const value{ next->data_ };
+        if (head_.compare_exchange_weak(head, next))
+        {
+            data.reset(value);
+            HazardPointers::clear(kSecondHazard);
+            HazardPointers::clear(kFirstHazard);
+            HazardPointers::retire(head);
+            size_.fetch_sub(1, std::memory_order_relaxed);
+            return data;
+        }
+    }
+
+    HazardPointers::clear(kSecondHazard);
+    HazardPointers::clear(kFirstHazard);
+    return data;
+}
+
+template <typename T, typename Wait>
+std::unique_ptr<T> LockFreeQueue<T, Wait>::wait_for_head()
+{
+    std::unique_ptr<T> data{ unlink_head() };
+    if (data)
+    {
+        return data;
+    }
+
+    NoLock lock{};
+    isPoppable_.wait(lock, [this, &data]()
+    {
+        data = unlink_head();
+        return static_cast<bool>(data);
+    });
+    return data;
+}
+
+template <typename T, typename Wait>
+void LockFreeQueue<T, Wait>::traverse_push(const LockFreeQueue& other)
+{
+    // Nodes after the head are never reclaimed without a pop, so they are safe to walk through
+    const Node* i{ other.head_.load()->next_.load() };
+    for (; i != nullptr; i = i->next_.load())
+    {
+        link_tail(std::make_unique<T>(*i->data_));
+    }
+}
+
+template <typename T, typename Wait>
+void LockFreeQueue<T, Wait>::release() noexcept
+{
+    // Values of all nodes, but the dummy head, are still owned by the queue
+    Node* node{ head_.load() };
+    if (node == nullptr)
+    {
+        return;
+    }
+
+    Node* next{ node->next_.load() };
+    delete node;
+    while (next != nullptr)
+    {
+        node = next;
+        next = node->next_.load();
+        delete node->data_;
+        delete node;
+    }
+}
+
+template <typename T, typename Wait>
+bool operator==(const LockFreeQueue<T, Wait>& one, const LockFreeQueue<T, Wait>& other)
+{
+    using Node = typename LockFreeQueue<T, Wait>::Node;
+
+    const Node* iterOne{ one.head_.load()->next_.load() };
+    const Node* iterOther{ other.head_.load()->next_.load() };
+    while ((iterOne != nullptr) && (iterOther != nullptr) &&
+        (*(iterOne->data_) == *(iterOther->data_)))
+    {
+        iterOne = iterOne->next_.load();
+        iterOther = iterOther->next_.load();
+    }
+
+    return iterOne == nullptr && iterOther == nullptr;
+}
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <limits>
+#include <mutex>
+
+#include "CacheLine.hpp"
+
+// Statistics policies of the queues: NoStats compiles to nothing, ContentionStats accounts
+// the traffic, the contention on every mutex and the time elements spend within a queue.
+// Each policy provides
+//
+//     template <typename Mutex>
+//     std::unique_lock<Mutex> lock(Mutex& mutex, LockSite site);
+//     template <typename Condition, typename Lock, typename Predicate>
+//     void wait(Condition& condition, Lock& lock, Predicate ready, WaitSite site);
+//     void pushed(std::size_t count);
+//     void popped(std::size_t count);
+//     QueueStatsSnapshot snapshot() const;
+//
+// A queue reports pushes and pops under the lock, which orders elements, so that the n-th push
+// and the n-th pop refer to the same element. Counters follow element operations and a content
+// a queue is constructed with, whereas moves, assignments and swaps carry content along unaccounted,
+// which skews depth and latency readings of the queues involved
+
+// Keep an empty policy from occupying any room within a queue
+#if defined(_MSC_VER)
+#define QUEUE_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#else
+#define QUEUE_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
+
+// Mutexes of the queues: the only one of BluntQueue and the head and tail ones of FineQueue
+enum class LockSite : std::size_t
+{
+    Storage,
+    Head,
+    Tail
+};
+
+// Blocking operations of the queues
+enum class WaitSite : std::size_t
+{
+    Push,
+    Pop
+};
+
+inline constexpr std::size_t kLockSites{ 3 };
+inline constexpr std::size_t kWaitSites{ 2 };
+// A bucket i counts latencies within [2^(i-1), 2^i) nanoseconds, the last one counts everything longer
+inline constexpr std::size_t kLatencyBuckets{ 36 };
+
+struct LockStats
+{
+    std::uint64_t acquisitions_;
+    // Contended acquisitions only, since free mutexes are taken without looking at the clock
+    std::uint64_t contentions_;
+    std::chrono::nanoseconds waited_;
+};
+
+struct QueueStatsSnapshot
+{
+    std::uint64_t pushes_;
+    std::uint64_t pops_;
+    std::uint64_t highWaterMark_;
+    std::array<LockStats, kLockSites> locks_;
+    std::array<std::chrono::nanoseconds, kWaitSites> blocked_;
+    std::array<std::uint64_t, kLatencyBuckets> latency_;
+};
+
+class NoStats
+{
+public:
+
+    template <typename Mutex>
+    std::unique_lock<Mutex> lock(Mutex& mutex, LockSite) const
+    {
+        return std::unique_lock<Mutex>{ mutex };
+    }
+
+    template <typename Condition, typename Lock, typename Predicate>
+    void wait(Condition& condition, Lock& lock, Predicate ready, WaitSite) const
+    {
+        condition.wait(lock, ready);
+    }
+
+    void pushed(std::size_t) const noexcept {}
+    void popped(std::size_t) const noexcept {}
+
+    QueueStatsSnapshot snapshot() const noexcept
+    {
+        return QueueStatsSnapshot{};
+    }
+
+};
+
+// Counters are updated by relaxed atomic operations and read without any synchronization,
+// so a snapshot is cheap, but merely consistent per counter.
+// Latencies are sampled by a single probe element at a time, which is stamped on push,
+// unless a previous probe is still in flight, and measured on pop
+class ContentionStats
+{
+public:
+
+    ContentionStats() = default;
+    ContentionStats(const ContentionStats& other) = delete;
+    ContentionStats& operator=(const ContentionStats& other) = delete;
+
+    template <typename Mutex>
+    std::unique_lock<Mutex> lock(Mutex& mutex, LockSite site);
+
+    template <typename Condition, typename Lock, typename Predicate>
+    void wait(Condition& condition, Lock& lock, Predicate ready, WaitSite site);
+
+    void pushed(std::size_t count) noexcept;
+    void popped(std::size_t count) noexcept;
+
+    QueueStatsSnapshot snapshot() const noexcept;
+
+private:
+
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::uint64_t kIdleProbe{ std::numeric_limits<std::uint64_t>::max() };
+
+    // Sites are updated by different parties, so they don't share cache lines
+    struct alignas(kCacheLineSize) LockCounters
+    {
+        std::atomic<std::uint64_t> acquisitions_{ 0 };
+        std::atomic<std::uint64_t> contentions_{ 0 };
+        std::atomic<std::int64_t> waited_{ 0 };
+    };
+
+    static std::int64_t since(Clock::time_point start) noexcept;
+
+    std::array<LockCounters, kLockSites> locks_{};
+
+    alignas(kCacheLineSize) std::atomic<std::uint64_t> pushes_{ 0 };
+    std::atomic<std::uint64_t> highWaterMark_{ 0 };
+    std::atomic<std::int64_t> pushBlocked_{ 0 };
+
+    alignas(kCacheLineSize) std::atomic<std::uint64_t> pops_{ 0 };
+    std::atomic<std::int64_t> popBlocked_{ 0 };
+
+    // An ordinal of the probe element, which is pushed at the stamped moment
+    alignas(kCacheLineSize) std::atomic<std::uint64_t> probe_{ kIdleProbe };
+    std::atomic<std::int64_t> probeStamp_{ 0 };
+    std::array<std::atomic<std::uint64_t>, kLatencyBuckets> latency_{};
+
+};
+
+template <typename Mutex>
+std::unique_lock<Mutex> ContentionStats::lock(Mutex& mutex, LockSite site)
+{
+    LockCounters& counters{ locks_[static_cast<std::size_t>(site)] };
+    counters.acquisitions_.fetch_add(1, std::memory_order_relaxed);
+
+    std::unique_lock<Mutex> lock{ mutex, std::try_to_lock };
+    if (!lock.owns_lock())
+    {
+        const Clock::time_point start{ Clock::now() };
+        lock.lock();
+        counters.contentions_.fetch_add(1, std::memory_order_relaxed);
+        counters.waited_.fetch_add(since(start), std::memory_order_relaxed);
+    }
+    return lock;
+}
+
+template <typename Condition, typename Lock, typename Predicate>
+void ContentionStats::wait(Condition& condition, Lock& lock, Predicate ready, WaitSite site)
+{
+    // Look at the clock only when it comes to blocking indeed
+    if (ready())
+    {
+        return;
+    }
+
+    const Clock::time_point start{ Clock::now() };
+    condition.wait(lock, ready);
+    std::atomic<std::int64_t>& blocked{ site == WaitSite::Push ? pushBlocked_ : popBlocked_ };
+    blocked.fetch_add(since(start), std::memory_order_relaxed);
+}
+
+inline void ContentionStats::pushed(std::size_t count) noexcept
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    const std::uint64_t first{ pushes_.fetch_add(count, std::memory_order_relaxed) };
+    const std::uint64_t popped{ pops_.load(std::memory_order_relaxed) };
+    const std::uint64_t pushed{ first + count };
+    const std::uint64_t depth{ pushed > popped ? pushed - popped : 0 };
+    std::uint64_t mark{ highWaterMark_.load(std::memory_order_relaxed) };
+    while (depth > mark && !highWaterMark_.compare_exchange_weak(mark, depth, std::memory_order_relaxed))
+    {
+        // Retry against a mark raised meanwhile
+    }
+
+    // Pushes are serialized by the caller, so the probe is launched by a single producer at a time
+    if (probe_.load(std::memory_order_acquire) == kIdleProbe)
+    {
+        probeStamp_.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        probe_.store(first, std::memory_order_release);
+    }
+}
+
+inline void ContentionStats::popped(std::size_t count) noexcept
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    const std::uint64_t first{ pops_.fetch_add(count, std::memory_order_relaxed) };
+    const std::uint64_t probe{ probe_.load(std::memory_order_acquire) };
+    if (probe == kIdleProbe || probe >= first + count)
+    {
+        return;
+    }
+
+    // A probe behind the pops has been carried away by an assignment or a swap, so just release it
+    if (probe >= first)
+    {
+        const Clock::duration latency{ Clock::now().time_since_epoch() -
+            Clock::duration{ probeStamp_.load(std::memory_order_relaxed) } };
+        const auto nanoseconds{ std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count() };
+        const std::size_t bucket{ static_cast<std::size_t>(std::bit_width(
+            static_cast<std::uint64_t>(nanoseconds > 0 ? nanoseconds : 0))) };
+        latency_[bucket < kLatencyBuckets ? bucket : kLatencyBuckets - 1].fetch_add(1, std::memory_order_relaxed);
+    }
+    probe_.store(kIdleProbe, std::memory_order_release);
+}
+
+inline QueueStatsSnapshot ContentionStats::snapshot() const noexcept
+{
+    QueueStatsSnapshot snapshot{};
+    snapshot.pushes_ = pushes_.load(std::memory_order_relaxed);
+    snapshot.pops_ = pops_.load(std::memory_order_relaxed);
+    snapshot.highWaterMark_ = highWaterMark_.load(std::memory_order_relaxed);
+    for (std::size_t s{ 0 }; s < kLockSites; ++s)
+    {
+        snapshot.locks_[s] = LockStats{
+            locks_[s].acquisitions_.load(std::memory_order_relaxed),
+            locks_[s].contentions_.load(std::memory_order_relaxed),
+            std::chrono::nanoseconds{ locks_[s].waited_.load(std::memory_order_relaxed) } };
+    }
+    snapshot.blocked_[static_cast<std::size_t>(WaitSite::Push)] =
+        std::chrono::nanoseconds{ pushBlocked_.load(std::memory_order_relaxed) };
+    snapshot.blocked_[static_cast<std::size_t>(WaitSite::Pop)] =
+        std::chrono::nanoseconds{ popBlocked_.load(std::memory_order_relaxed) };
+    for (std::size_t b{ 0 }; b < kLatencyBuckets; ++b)
+    {
+        snapshot.latency_[b] = latency_[b].load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+inline std::int64_t ContentionStats::since(Clock::time_point start) noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
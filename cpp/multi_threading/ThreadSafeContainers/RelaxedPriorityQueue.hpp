@@ -0,0 +1,342 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "CacheLine.hpp"
+#include "WaitPolicies.hpp"
+
+// A multi-queue: a relaxed concurrent priority queue, which keeps elements in several binary heaps
+// guarded by their own locks. A push goes to a random heap, whereas a pop compares the tops
+// of two random heaps and takes the better one, so parties rarely meet at the same lock.
+//
+// Elements come out the smallest first according to the comparison, like deadlines do, though not strictly:
+// a pop returns one of the smallest elements with high probability, and the rank error grows
+// with the number of heaps only. A queue with a single heap is an exact priority queue.
+// Waiting consumers block according to the wait policy. Heaps are neither copied nor moved, so neither is the queue
+template <typename T, typename Compare = std::less<T>, typename Wait = BlockWait>
+class RelaxedPriorityQueue
+{
+public:
+    using size_type = std::size_t;
+
+    explicit RelaxedPriorityQueue(size_type heaps = default_heap_count(), Compare compare = Compare{});
+
+    RelaxedPriorityQueue(const RelaxedPriorityQueue& other) = delete;
+    RelaxedPriorityQueue(RelaxedPriorityQueue&& other) = delete;
+    RelaxedPriorityQueue& operator=(const RelaxedPriorityQueue& other) = delete;
+    RelaxedPriorityQueue& operator=(RelaxedPriorityQueue&& other) = delete;
+
+    ~RelaxedPriorityQueue() noexcept = default;
+
+    void push(T value);
+
+    template <typename... Args>
+    void emplace(Args&&... args);
+
+    // A trying pop fails only when the queue is empty
+    bool try_pop(T& value);
+    std::shared_ptr<T> try_pop();
+
+    void wait_and_pop(T& value);
+    std::shared_ptr<T> wait_and_pop();
+
+    // Popping up to the given number of elements, the smallest first, returning the number of retrieved ones.
+    // Elements are merged from the tops of two heaps at a time, so a batch costs a couple of lock acquisitions.
+    // A waiting version waits for at least one element
+    template <typename OutputIt>
+    size_type pop_min_n(OutputIt out, size_type maxCount);
+    template <typename OutputIt>
+    size_type wait_and_pop_min_n(OutputIt out, size_type maxCount);
+
+    // The size is tracked by a counter, so it is exact only in absence of concurrent modifications
+    size_type size() const noexcept;
+    bool empty() const noexcept;
+
+    size_type heap_count() const noexcept;
+
+    // A couple of heaps per hardware thread keeps the chance of two parties picking the same heap low
+    static size_type default_heap_count() noexcept;
+
+private:
+
+    // Heaps are modified by different cores, so they don't share cache lines
+    struct alignas(kCacheLineSize) Heap
+    {
+        std::mutex mutex_;
+        std::vector<T> elements_;
+    };
+
+    size_type random_heap();
+    void push_heap(Heap& heap, T value);
+    T pop_heap(Heap& heap);
+    // Whether the top of one heap is to be popped before the top of another one, or an empty one
+    bool precedes(const Heap& one, const Heap& other) const;
+
+    template <typename Take>
+    size_type pop_with(Take take, size_type maxCount);
+
+    const size_type count_;
+    // The standard heap algorithms keep the largest element on top, so they get the comparison reversed
+    const Compare compare_;
+    std::unique_ptr<Heap[]> heaps_;
+
+    // Elements are counted before being pushed and discounted after being popped,
+    // so that consumers skip useless probes of an empty queue and the counter never goes negative
+    alignas(kCacheLineSize) std::atomic<size_type> size_;
+
+    Wait isPoppable_;
+
+};
+
+template <typename T, typename Compare, typename Wait>
+RelaxedPriorityQueue<T, Compare, Wait>::RelaxedPriorityQueue(size_type heaps, Compare compare) :
+    count_{ std::max<size_type>(heaps, 1) },
+    compare_{ std::move(compare) },
+    heaps_{ std::make_unique<Heap[]>(count_) },
+    size_{ 0 },
+    isPoppable_{}
+{
+    // Empty
+}
+
+template <typename T, typename Compare, typename Wait>
+void RelaxedPriorityQueue<T, Compare, Wait>::push(T value)
+{
+    emplace(std::move(value));
+}
+
+template <typename T, typename Compare, typename Wait>
+template <typename... Args>
+void RelaxedPriorityQueue<T, Compare, Wait>::emplace(Args&&... args)
+{
+    T value(std::forward<Args>(args)...);
+    size_.fetch_add(1);
+    try
+    {
+        // Prefer a heap nobody holds right now, and put up with a busy one after a few misses
+        constexpr int kAttempts{ 4 };
+        for (int attempt{ 1 }; ; ++attempt)
+        {
+            Heap& heap{ heaps_[random_heap()] };
+            std::unique_lock<std::mutex> lock{ heap.mutex_, std::defer_lock };
+            if (attempt < kAttempts)
+            {
+                if (!lock.try_lock())
+                {
+                    continue;
+                }
+            }
+            else
+            {
+                lock.lock();
+            }
+
+            push_heap(heap, std::move(value));
+            break;
+        }
+    }
+    catch (...)
+    {
+        size_.fetch_sub(1);
+        throw;
+    }
+
+    isPoppable_.notify_one();
+}
+
+template <typename T, typename Compare, typename Wait>
+bool RelaxedPriorityQueue<T, Compare, Wait>::try_pop(T& value)
+{
+    return pop_with([&value](T&& top) { value = std::move(top); }, 1) == 1;
+}
+
+template <typename T, typename Compare, typename Wait>
+std::shared_ptr<T> RelaxedPriorityQueue<T, Compare, Wait>::try_pop()
+{
+    std::shared_ptr<T> value{};
+    pop_with([&value](T&& top) { value = std::make_shared<T>(std::move(top)); }, 1);
+    return value;
+}
+
+template <typename T, typename Compare, typename Wait>
+void RelaxedPriorityQueue<T, Compare, Wait>::wait_and_pop(T& value)
+{
+    NoLock lock{};
+    isPoppable_.wait(lock, [this, &value]() { return try_pop(value); });
+}
+
+template <typename T, typename Compare, typename Wait>
+std::shared_ptr<T> RelaxedPriorityQueue<T, Compare, Wait>::wait_and_pop()
+{
+    std::shared_ptr<T> value{};
+    NoLock lock{};
+    isPoppable_.wait(lock, [this, &value]()
+    {
+        value = try_pop();
+        return static_cast<bool>(value);
+    });
+    return value;
+}
+
+template <typename T, typename Compare, typename Wait>
+template <typename OutputIt>
+typename RelaxedPriorityQueue<T, Compare, Wait>::size_type RelaxedPriorityQueue<T, Compare, Wait>::pop_min_n(
+    OutputIt out, size_type maxCount)
+{
+    return pop_with([&out](T&& top) { *out++ = std::move(top); }, maxCount);
+}
+
+template <typename T, typename Compare, typename Wait>
+template <typename OutputIt>
+typename RelaxedPriorityQueue<T, Compare, Wait>::size_type RelaxedPriorityQueue<T, Compare, Wait>::wait_and_pop_min_n(
+    OutputIt out, size_type maxCount)
+{
+    if (maxCount == 0)
+    {
+        return 0;
+    }
+
+    size_type count{ 0 };
+    NoLock lock{};
+    isPoppable_.wait(lock, [this, &out, &count, maxCount]()
+    {
+        count = pop_min_n(out, maxCount);
+        return count != 0;
+    });
+    return count;
+}
+
+template <typename T, typename Compare, typename Wait>
+typename RelaxedPriorityQueue<T, Compare, Wait>::size_type RelaxedPriorityQueue<T, Compare, Wait>::size() const noexcept
+{
+    return size_.load(std::memory_order_relaxed);
+}
+
+template <typename T, typename Compare, typename Wait>
+bool RelaxedPriorityQueue<T, Compare, Wait>::empty() const noexcept
+{
+    return size() == 0;
+}
+
+template <typename T, typename Compare, typename Wait>
+typename RelaxedPriorityQueue<T, Compare, Wait>::size_type RelaxedPriorityQueue<T, Compare, Wait>::heap_count() const noexcept
+{
+    return count_;
+}
+
+template <typename T, typename Compare, typename Wait>
+typename RelaxedPriorityQueue<T, Compare, Wait>::size_type RelaxedPriorityQueue<T, Compare, Wait>::default_heap_count() noexcept
+{
+    return 2 * static_cast<size_type>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+template <typename T, typename Compare, typename Wait>
+typename RelaxedPriorityQueue<T, Compare, Wait>::size_type RelaxedPriorityQueue<T, Compare, Wait>::random_heap()
+{
+    thread_local std::minstd_rand engine{ static_cast<std::minstd_rand::result_type>(
+        std::hash<std::thread::id>{}(std::this_thread::get_id())) };
+    return count_ == 1 ? 0 : static_cast<size_type>(engine()) % count_;
+}
+
+template <typename T, typename Compare, typename Wait>
+void RelaxedPriorityQueue<T, Compare, Wait>::push_heap(Heap& heap, T value)
+{
+    heap.elements_.push_back(std::move(value));
+    std::push_heap(heap.elements_.begin(), heap.elements_.end(),
+        [this](const T& one, const T& other) { return compare_(other, one); });
+}
+
+template <typename T, typename Compare, typename Wait>
+T RelaxedPriorityQueue<T, Compare, Wait>::pop_heap(Heap& heap)
+{
+    std::pop_heap(heap.elements_.begin(), heap.elements_.end(),
+        [this](const T& one, const T& other) { return compare_(other, one); });
+    T top{ std::move(heap.elements_.back()) };
+    heap.elements_.pop_back();
+    return top;
+}
+
+template <typename T, typename Compare, typename Wait>
+bool RelaxedPriorityQueue<T, Compare, Wait>::precedes(const Heap& one, const Heap& other) const
+{
+    if (one.elements_.empty())
+    {
+        return false;
+    }
+    return other.elements_.empty() || !compare_(other.elements_.front(), one.elements_.front());
+}
+
+template <typename T, typename Compare, typename Wait>
+template <typename Take>
+typename RelaxedPriorityQueue<T, Compare, Wait>::size_type RelaxedPriorityQueue<T, Compare, Wait>::pop_with(
+    Take take, size_type maxCount)
+{
+    size_type count{ 0 };
+    const auto discount = [this, &count]()
+    {
+        if (count != 0)
+        {
+            size_.fetch_sub(count);
+        }
+    };
+
+    // A couple of random pairs find an element of a populated queue as a rule,
+    // and a sweep over all heaps makes sure a trying pop never misses one for good
+    constexpr size_type kPairs{ 2 };
+    for (size_type round{ 0 }; round < kPairs + count_ && count < maxCount; ++round)
+    {
+        if (size_.load() == 0)
+        {
+            break;
+        }
+
+        const bool sweep{ round >= kPairs };
+        const size_type i{ sweep ? round - kPairs : random_heap() };
+        const size_type j{ sweep ? (i + 1) % count_ : random_heap() };
+        Heap& one{ heaps_[i] };
+        Heap& other{ heaps_[j] };
+
+        std::unique_lock<std::mutex> lockOne{ one.mutex_, std::defer_lock };
+        std::unique_lock<std::mutex> lockOther{ other.mutex_, std::defer_lock };
+        if (i == j)
+        {
+            lockOne.lock();
+        }
+        else
+        {
+            std::lock(lockOne, lockOther);
+        }
+
+        // Merge the best of both heaps into the output
+        try
+        {
+            while (count < maxCount)
+            {
+                Heap* best{ precedes(one, other) ? &one : &other };
+                if (best->elements_.empty())
+                {
+                    break;
+                }
+                take(pop_heap(*best));
+                ++count;
+            }
+        }
+        catch (...)
+        {
+            discount();
+            throw;
+        }
+    }
+
+    discount();
+    return count;
+}
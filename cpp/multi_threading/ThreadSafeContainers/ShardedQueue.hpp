@@ -0,0 +1,273 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "CacheLine.hpp"
+#include "FineQueue.hpp"
+#include "ThreadPlacement.h"
+#include "WaitPolicies.hpp"
+
+// Ordering guarantees of ShardedQueue: a relaxed queue keeps elements of every producer thread
+// in the order of pushes within a single shard, but interleaves shards arbitrarily,
+// whereas a strict queue falls back to a single shard to keep FIFO order across all threads
+enum class ShardOrdering
+{
+    Relaxed,
+    Strict
+};
+
+// A queue, which stripes elements across several shards, each of them being a queue on its own,
+// to spread the contention of many cores over many locks. Every thread has got a home shard,
+// which it pushes to and starts looking for elements at, before scanning the other ones round-robin.
+//
+// A shard is expected to provide push, emplace and trying pops of BluntQueue and FineQueue.
+// Waiting consumers block according to the wait policy of the sharded queue itself.
+// Shards are neither copied nor moved, so neither is the queue
+template <typename T, typename Shard = FineQueue<T>, typename Wait = BlockWait>
+class ShardedQueue
+{
+public:
+    using size_type = std::size_t;
+
+    explicit ShardedQueue(size_type shards = default_shard_count(), ShardOrdering ordering = ShardOrdering::Relaxed);
+    // A shard per NUMA node of the placement, whose home shard is the one of the node a thread runs on,
+    // so that pinned producers and consumers of a node keep to its shard
+    explicit ShardedQueue(const ThreadPlacement& placement);
+
+    ShardedQueue(const ShardedQueue& other) = delete;
+    ShardedQueue(ShardedQueue&& other) = delete;
+    ShardedQueue& operator=(const ShardedQueue& other) = delete;
+    ShardedQueue& operator=(ShardedQueue&& other) = delete;
+
+    ~ShardedQueue() noexcept = default;
+
+    void push(T value);
+
+    template <typename... Args>
+    void emplace(Args&&... args);
+
+    bool try_pop(T& value);
+    std::shared_ptr<T> try_pop();
+
+    void wait_and_pop(T& value);
+    std::shared_ptr<T> wait_and_pop();
+
+    // The size is tracked by a counter, so it is exact only in absence of concurrent modifications
+    size_type size() const noexcept;
+    bool empty() const noexcept;
+
+    size_type shard_count() const noexcept;
+    ShardOrdering ordering() const noexcept;
+
+    // A shard per hardware thread
+    static size_type default_shard_count() noexcept;
+
+private:
+
+    // Shards are modified by different cores, so they don't share cache lines
+    struct alignas(kCacheLineSize) Padded
+    {
+        Shard queue_;
+    };
+
+    // Spread threads across shards evenly in the order they touch the queue for the first time
+    static size_type thread_ticket() noexcept;
+    size_type home_shard() const;
+
+    template <typename Push>
+    void push_home(Push push);
+    template <typename Pop>
+    bool scan(Pop pop);
+
+    const size_type count_;
+    const ShardOrdering ordering_;
+    std::unique_ptr<Padded[]> shards_;
+    // Shards of the processors, which are known to the placement, if any
+    std::vector<size_type> shardOfCpu_;
+
+    // Elements are counted before being pushed and discounted after being popped,
+    // so that consumers skip useless scans of an empty queue and the counter never goes negative
+    alignas(kCacheLineSize) std::atomic<size_type> size_;
+
+    Wait isPoppable_;
+
+};
+
+template <typename T, typename Shard, typename Wait>
+ShardedQueue<T, Shard, Wait>::ShardedQueue(size_type shards, ShardOrdering ordering) :
+    count_{ ordering == ShardOrdering::Strict ? 1 : std::max<size_type>(shards, 1) },
+    ordering_{ ordering },
+    shards_{ std::make_unique<Padded[]>(count_) },
+    shardOfCpu_{},
+    size_{ 0 },
+    isPoppable_{}
+{
+    // Empty
+}
+
+template <typename T, typename Shard, typename Wait>
+ShardedQueue<T, Shard, Wait>::ShardedQueue(const ThreadPlacement& placement) :
+    ShardedQueue{ placement.topology().node_count() }
+{
+    const std::vector<NumaNode>& nodes{ placement.topology().nodes() };
+    for (size_type n{ 0 }; n < nodes.size(); ++n)
+    {
+        for (const unsigned cpu : nodes[n].cpus_)
+        {
+            if (cpu >= shardOfCpu_.size())
+            {
+                shardOfCpu_.resize(cpu + 1, 0);
+            }
+            shardOfCpu_[cpu] = n;
+        }
+    }
+}
+
+template <typename T, typename Shard, typename Wait>
+void ShardedQueue<T, Shard, Wait>::push(T value)
+{
+    push_home([&value](Shard& shard) { shard.push(std::move(value)); });
+}
+
+template <typename T, typename Shard, typename Wait>
+template <typename... Args>
+void ShardedQueue<T, Shard, Wait>::emplace(Args&&... args)
+{
+    push_home([&args...](Shard& shard) { shard.emplace(std::forward<Args>(args)...); });
+}
+
+template <typename T, typename Shard, typename Wait>
+bool ShardedQueue<T, Shard, Wait>::try_pop(T& value)
+{
+    return scan([&value](Shard& shard) { return shard.try_pop(value); });
+}
+
+template <typename T, typename Shard, typename Wait>
+std::shared_ptr<T> ShardedQueue<T, Shard, Wait>::try_pop()
+{
+    std::shared_ptr<T> value{};
+    scan([&value](Shard& shard)
+    {
+        value = shard.try_pop();
+        return static_cast<bool>(value);
+    });
+    return value;
+}
+
+template <typename T, typename Shard, typename Wait>
+void ShardedQueue<T, Shard, Wait>::wait_and_pop(T& value)
+{
+    NoLock lock{};
+    isPoppable_.wait(lock, [this, &value]() { return try_pop(value); });
+}
+
+template <typename T, typename Shard, typename Wait>
+std::shared_ptr<T> ShardedQueue<T, Shard, Wait>::wait_and_pop()
+{
+    std::shared_ptr<T> value{};
+    NoLock lock{};
+    isPoppable_.wait(lock, [this, &value]()
+    {
+        value = try_pop();
+        return static_cast<bool>(value);
+    });
+    return value;
+}
+
+template <typename T, typename Shard, typename Wait>
+typename ShardedQueue<T, Shard, Wait>::size_type ShardedQueue<T, Shard, Wait>::size() const noexcept
+{
+    return size_.load(std::memory_order_relaxed);
+}
+
+template <typename T, typename Shard, typename Wait>
+bool ShardedQueue<T, Shard, Wait>::empty() const noexcept
+{
+    return size() == 0;
+}
+
+template <typename T, typename Shard, typename Wait>
+typename ShardedQueue<T, Shard, Wait>::size_type ShardedQueue<T, Shard, Wait>::shard_count() const noexcept
+{
+    return count_;
+}
+
+template <typename T, typename Shard, typename Wait>
+ShardOrdering ShardedQueue<T, Shard, Wait>::ordering() const noexcept
+{
+    return ordering_;
+}
+
+template <typename T, typename Shard, typename Wait>
+typename ShardedQueue<T, Shard, Wait>::size_type ShardedQueue<T, Shard, Wait>::default_shard_count() noexcept
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+template <typename T, typename Shard, typename Wait>
+typename ShardedQueue<T, Shard, Wait>::size_type ShardedQueue<T, Shard, Wait>::thread_ticket() noexcept
+{
+    static std::atomic<size_type> next{ 0 };
+    thread_local const size_type ticket{ next.fetch_add(1, std::memory_order_relaxed) };
+    return ticket;
+}
+
+template <typename T, typename Shard, typename Wait>
+typename ShardedQueue<T, Shard, Wait>::size_type ShardedQueue<T, Shard, Wait>::home_shard() const
+{
+    if (!shardOfCpu_.empty())
+    {
+        const std::optional<unsigned> cpu{ ThreadPlacement::current_cpu() };
+        if (cpu && *cpu < shardOfCpu_.size())
+        {
+            return shardOfCpu_[*cpu];
+        }
+    }
+    return thread_ticket() % count_;
+}
+
+template <typename T, typename Shard, typename Wait>
+template <typename Push>
+void ShardedQueue<T, Shard, Wait>::push_home(Push push)
+{
+    size_.fetch_add(1);
+    try
+    {
+        push(shards_[home_shard()].queue_);
+    }
+    catch (...)
+    {
+        size_.fetch_sub(1);
+        throw;
+    }
+
+    isPoppable_.notify_one();
+}
+
+template <typename T, typename Shard, typename Wait>
+template <typename Pop>
+bool ShardedQueue<T, Shard, Wait>::scan(Pop pop)
+{
+    if (size_.load() == 0)
+    {
+        return false;
+    }
+
+    const size_type home{ home_shard() };
+    for (size_type s{ 0 }; s < count_; ++s)
+    {
+        if (pop(shards_[(home + s) % count_].queue_))
+        {
+            size_.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+
+#include "CacheLine.hpp"
+
+// A fixed-capacity ring buffer for exactly one producer thread and exactly one consumer thread.
+// Giving up the generality of BluntQueue and FineQueue allows hand-offs without any locks:
+// each side owns an index, publishes it with a release store and observes the other one with an acquire load
+template <typename T, std::size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+        "Expecting a power of two capacity to map indices onto slots with a mask");
+
+public:
+    using size_type = std::size_t;
+
+    SpscQueue();
+
+    // Both ends are bound to particular threads, so relocating the queue makes no sense
+    SpscQueue(const SpscQueue& other) = delete;
+    SpscQueue(SpscQueue&& other) = delete;
+    SpscQueue& operator=(const SpscQueue& other) = delete;
+    SpscQueue& operator=(SpscQueue&& other) = delete;
+
+    ~SpscQueue() noexcept;
+
+    // Producer side: blocking versions wait for a vacant slot, try versions give up on a full queue
+    void push(T value);
+    bool try_push(const T& value);
+    bool try_push(T&& value);
+
+    template <typename... Args>
+    void emplace(Args&&... args);
+
+    template <typename... Args>
+    bool try_emplace(Args&&... args);
+
+    // Consumer side
+    bool try_pop(T& value);
+    bool wait_and_pop(T& value);
+
+    // Observers might be called from any thread, though the result is merely a snapshot then
+    bool empty() const;
+    size_type size() const;
+    static constexpr size_type capacity() noexcept;
+
+private:
+
+    // Raw storage for an element, which is constructed on push and destroyed on pop
+    struct Slot
+    {
+        alignas(T) unsigned char bytes_[sizeof(T)];
+    };
+
+    static constexpr size_type kMask{ Capacity - 1 };
+
+    void* slot(size_type index) noexcept;
+    T* element(size_type index) noexcept;
+
+    // Position of the next element to pop, which is modified by the consumer only.
+    // The consumer also caches the last seen tail to touch the producer's cache line only when needed
+    alignas(kCacheLineSize) std::atomic<size_type> head_;
+    size_type tailCache_;
+
+    // Position of the next slot to push into, which is modified by the producer only
+    alignas(kCacheLineSize) std::atomic<size_type> tail_;
+    size_type headCache_;
+
+    alignas(kCacheLineSize) std::unique_ptr<Slot[]> slots_;
+
+};
+
+template <typename T, std::size_t Capacity>
+SpscQueue<T, Capacity>::SpscQueue() :
+    head_{ 0 },
+    tailCache_{ 0 },
+    tail_{ 0 },
+    headCache_{ 0 },
+    slots_{ std::make_unique<Slot[]>(Capacity) }
+{
+    // Empty
+}
+
+template <typename T, std::size_t Capacity>
+SpscQueue<T, Capacity>::~SpscQueue() noexcept
+{
+    const size_type tail{ tail_.load(std::memory_order_relaxed) };
+    for (size_type i{ head_.load(std::memory_order_relaxed) }; i != tail; ++i)
+    {
+        element(i)->~T();
+    }
+}
+
+template <typename T, std::size_t Capacity>
+void SpscQueue<T, Capacity>::push(T value)
+{
+    while (!try_push(std::move(value)))
+    {
+        std::this_thread::yield();
+    }
+}
+
+template <typename T, std::size_t Capacity>
+bool SpscQueue<T, Capacity>::try_push(const T& value)
+{
+    return try_emplace(value);
+}
+
+template <typename T, std::size_t Capacity>
+bool SpscQueue<T, Capacity>::try_push(T&& value)
+{
+    return try_emplace(std::move(value));
+}
+
+template <typename T, std::size_t Capacity>
+template <typename... Args>
+void SpscQueue<T, Capacity>::emplace(Args&&... args)
+{
+    // Arguments are forwarded once a slot is vacant, so retrying never consumes them
+    while (!try_emplace(std::forward<Args>(args)...))
+    {
+        std::this_thread::yield();
+    }
+}
+
+template <typename T, std::size_t Capacity>
+template <typename... Args>
+bool SpscQueue<T, Capacity>::try_emplace(Args&&... args)
+{
+    const size_type tail{ tail_.load(std::memory_order_relaxed) };
+    if (tail - headCache_ == Capacity)
+    {
+        headCache_ = head_.load(std::memory_order_acquire);
+        if (tail - headCache_ == Capacity)
+        {
+            return false;
+        }
+    }
+
+    // Should the construction throw, the slot is left unpublished and the queue intact
+    ::new (slot(tail)) T(std::forward<Args>(args)...);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T, std::size_t Capacity>
+bool SpscQueue<T, Capacity>::try_pop(T& value)
+{
+    const size_type head{ head_.load(std::memory_order_relaxed) };
+    if (head == tailCache_)
+    {
+        tailCache_ = tail_.load(std::memory_order_acquire);
+        if (head == tailCache_)
+        {
+            return false;
+        }
+    }
+
+    T* const front{ element(head) };
+    value = std::move(*front);
+    front->~T();
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T, std::size_t Capacity>
+bool SpscQueue<T, Capacity>::wait_and_pop(T& value)
+{
+    while (!try_pop(value))
+    {
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+template <typename T, std::size_t Capacity>
+bool SpscQueue<T, Capacity>::empty() const
+{
+    return size() == 0;
+}
+
+template <typename T, std::size_t Capacity>
+typename SpscQueue<T, Capacity>::size_type SpscQueue<T, Capacity>::size() const
+{
+    // Reading the head first guarantees the tail is not behind it
+    const size_type head{ head_.load(std::memory_order_acquire) };
+    const size_type tail{ tail_.load(std::memory_order_acquire) };
+    return tail - head;
+}
+
+template <typename T, std::size_t Capacity>
+constexpr typename SpscQueue<T, Capacity>::size_type SpscQueue<T, Capacity>::capacity() noexcept
+{
+    return Capacity;
+}
+
+template <typename T, std::size_t Capacity>
+void* SpscQueue<T, Capacity>::slot(size_type index) noexcept
+{
+    return slots_[index & kMask].bytes_;
+}
+
+template <typename T, std::size_t Capacity>
+T* SpscQueue<T, Capacity>::element(size_type index) noexcept
+{
+    return std::launder(static_cast<T*>(slot(index)));
+}
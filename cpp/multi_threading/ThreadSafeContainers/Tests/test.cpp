@@ -3,10 +3,31 @@
 #include <thread>
 #include <chrono>
 #include <tuple>
+#include <atomic>
+#include <vector>
+#include <iterator>
+#include <future>
+#include <optional>
+#include <memory>
+#include <stdexcept>
+#include <numeric>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <coroutine>
+#include <exception>
 
 #include <BluntQueue.hpp>
+#include <ChunkedQueue.hpp>
 #include <FineQueue.hpp>
+#include <LockFreeQueue.hpp>
+#include <RelaxedPriorityQueue.hpp>
+#include <ShardedQueue.hpp>
+#include <SpscQueue.hpp>
+#include <ThreadPlacement.h>
+#include <ThreadPool.h>
 #include <ThreadStorage.h>
+#include <WorkStealingDeque.hpp>
 
 TEST(BluntQueueTests, DefaultConstruction)
 {
@@ -241,6 +262,171 @@ TEST(BluntQueueTests, Swap)
         << "Expecting the BluntQueue to have an element less after a swap and a pop";
 }
 
+TEST(BluntQueueTests, BoundedTryPush)
+{
+    BluntQueue<int> queue{ QueueCapacity{ 2 } };
+
+    ASSERT_TRUE(queue.try_push(1));
+    ASSERT_TRUE(queue.try_push(2));
+    ASSERT_FALSE(queue.try_push(3)) << "Expecting a full BluntQueue to reject a value\n";
+    ASSERT_EQ(2, queue.size()) << "Expecting a BluntQueue not to exceed its capacity\n";
+}
+
+TEST(BluntQueueTests, ZeroCapacity)
+{
+    ASSERT_THROW(BluntQueue<int>{ QueueCapacity{ 0 } }, std::invalid_argument)
+        << "Expecting a BluntQueue to reject a capacity, which fits no elements\n";
+}
+
+TEST(BluntQueueTests, BoundedWaitAndPush)
+{
+    BluntQueue<int> queue{ QueueCapacity{ 1 } };
+    queue.push(10);
+    {
+        ThreadStorage threads{ 2u };
+        threads[0] = std::thread{ [&queue]()
+        {
+            queue.wait_and_push(20);
+        } };
+        threads[1] = std::thread{ [&queue]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            int front{};
+            queue.try_pop(front);
+        } };
+    }
+
+    BluntQueue<int> expected = { 20 };
+    ASSERT_EQ(expected, queue) << "Expecting a producer to wait for a vacant place\n";
+}
+
+TEST(BluntQueueTests, CloseWakesConsumers)
+{
+    BluntQueue<int> queue{};
+    std::atomic<int> failures{ 0 };
+    {
+        ThreadStorage threads{ 3u };
+        threads[0] = std::thread{ [&queue, &failures]()
+        {
+            int front{};
+            failures += queue.wait_and_pop(front) ? 0 : 1;
+        } };
+        threads[1] = std::thread{ [&queue, &failures]()
+        {
+            failures += queue.wait_and_pop() ? 0 : 1;
+        } };
+        threads[2] = std::thread{ [&queue]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            queue.close();
+        } };
+    }
+
+    ASSERT_EQ(2, failures.load()) << "Expecting all waiting consumers to give up on a closed BluntQueue\n";
+}
+
+TEST(BluntQueueTests, CloseDrainsRemaining)
+{
+    BluntQueue<int> queue = { 5, 3 };
+
+    queue.close();
+
+    int first{}, second{}, third{};
+    ASSERT_FALSE(queue.wait_and_push(7)) << "Expecting a closed BluntQueue to reject values\n";
+    ASSERT_FALSE(queue.try_push(7)) << "Expecting a closed BluntQueue to reject values\n";
+    ASSERT_TRUE(queue.wait_and_pop(first));
+    ASSERT_TRUE(queue.wait_and_pop(second));
+    ASSERT_FALSE(queue.wait_and_pop(third)) << "Expecting a drained closed BluntQueue to stop consumers\n";
+    ASSERT_EQ(5, first) << "Expecting remaining values to be delivered in order\n";
+    ASSERT_EQ(3, second) << "Expecting remaining values to be delivered in order\n";
+}
+
+TEST(BluntQueueTests, CloseWakesProducers)
+{
+    BluntQueue<int> queue{ QueueCapacity{ 1 } };
+    queue.push(1);
+    bool pushed{ true };
+    {
+        ThreadStorage threads{ 2u };
+        threads[0] = std::thread{ [&queue, &pushed]()
+        {
+            pushed = queue.wait_and_push(2);
+        } };
+        threads[1] = std::thread{ [&queue]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            queue.close();
+        } };
+    }
+
+    ASSERT_FALSE(pushed) << "Expecting a waiting producer to give up on a closed BluntQueue\n";
+    ASSERT_EQ(1, queue.size()) << "Expecting a BluntQueue to retain the accepted value\n";
+}
+
+TEST(BluntQueueTests, PushRangeAndTryPopBulk)
+{
+    const std::vector<int> values{ 4, 8, 15, 16, 23, 42 };
+    BluntQueue<int> queue{};
+
+    const auto pushed = queue.push_range(values.cbegin(), values.cend());
+
+    std::vector<int> popped{};
+    const auto first = queue.try_pop_bulk(std::back_inserter(popped), 4);
+    const auto second = queue.try_pop_bulk(std::back_inserter(popped), 4);
+    const auto third = queue.try_pop_bulk(std::back_inserter(popped), 4);
+
+    ASSERT_EQ(values.size(), pushed) << "Expecting a BluntQueue to accept the whole range\n";
+    ASSERT_EQ(4, first) << "Expecting a bulk pop to be limited by the requested number\n";
+    ASSERT_EQ(2, second) << "Expecting a bulk pop to be limited by available elements\n";
+    ASSERT_EQ(0, third) << "Expecting a bulk pop from an empty BluntQueue to retrieve nothing\n";
+    ASSERT_EQ(values, popped) << "Expecting a batch to preserve the order\n";
+}
+
+TEST(BluntQueueTests, BoundedPushBulk)
+{
+    std::vector<std::unique_ptr<int>> values{};
+    for (int i{ 0 }; i < 100; ++i)
+    {
+        values.push_back(std::make_unique<int>(i));
+    }
+    BluntQueue<std::unique_ptr<int>> queue{ QueueCapacity{ 8 } };
+
+    std::vector<std::unique_ptr<int>> popped{};
+    {
+        ThreadStorage threads{ 2u };
+        threads[0] = std::thread{ [&queue, &values]()
+        {
+            queue.push_bulk(values);
+        } };
+        threads[1] = std::thread{ [&queue, &popped]()
+        {
+            while (popped.size() < 100)
+            {
+                queue.wait_and_pop_bulk(std::back_inserter(popped), 16);
+            }
+        } };
+    }
+
+    bool ordered{ true };
+    for (int i{ 0 }; i < 100; ++i)
+    {
+        ordered = ordered && (*popped[i] == i);
+    }
+    ASSERT_TRUE(ordered) << "Expecting a bounded BluntQueue to pass a batch through in order\n";
+}
+
+TEST(BluntQueueTests, ClosedWaitAndPopBulk)
+{
+    BluntQueue<int> queue{};
+    queue.close();
+
+    std::vector<int> popped{};
+    const auto count = queue.wait_and_pop_bulk(std::back_inserter(popped), 4);
+
+    ASSERT_EQ(0, count) << "Expecting a closed and drained BluntQueue to retrieve nothing\n";
+    ASSERT_EQ(0, queue.push_range(popped.cbegin(), popped.cend()));
+}
+
 TEST(FineQueueTests, DefaultConstruction)
 {
     FineQueue<int> queue{};
@@ -542,4 +728,1366 @@ TEST(FineQueueTests, Swap)
     const FineQueue<int> reference2{ init1 };
     ASSERT_EQ(queue1, reference1) << "Expecting a queue to grab partner's elements";
     ASSERT_EQ(queue2, reference2) << "Expecting a queue to grab partner's elements";
-}
\ No newline at end of file
+}
+
+TEST(SpscQueueTests, EmptyTryPop)
+{
+    SpscQueue<int, 4> queue{};
+
+    int front{};
+    const bool responce = queue.try_pop(front);
+
+    ASSERT_FALSE(responce) << "Expecting a failed attempt to pop from an empty queue\n";
+    ASSERT_TRUE(queue.empty()) << "Expecting a fresh queue to be empty\n";
+}
+
+TEST(SpscQueueTests, PushAndTryPop)
+{
+    constexpr int v1{ 8 }, v2{ 13 }, v3{ 62 };
+    SpscQueue<int, 4> queue{};
+    queue.push(v1);
+    queue.push(v2);
+    queue.push(v3);
+
+    int p1{}, p2{}, p3{}, p4{};
+    ASSERT_TRUE(queue.try_pop(p1));
+    ASSERT_TRUE(queue.try_pop(p2));
+    ASSERT_TRUE(queue.try_pop(p3));
+    ASSERT_FALSE(queue.try_pop(p4)) << "Expecting an empty queue afterwards\n";
+
+    ASSERT_EQ(p1, v1) << "Expecting the first element to show up first\n";
+    ASSERT_EQ(p2, v2) << "Expecting the second element to show up second\n";
+    ASSERT_EQ(p3, v3) << "Expecting the third element to show up third\n";
+}
+
+TEST(SpscQueueTests, FullTryPush)
+{
+    SpscQueue<int, 2> queue{};
+
+    ASSERT_TRUE(queue.try_push(1));
+    ASSERT_TRUE(queue.try_push(2));
+    ASSERT_FALSE(queue.try_push(3)) << "Expecting a full queue to reject a value\n";
+    ASSERT_EQ(queue.capacity(), queue.size()) << "Expecting a queue to be filled up to the capacity\n";
+}
+
+TEST(SpscQueueTests, Emplace)
+{
+    using Tuple = std::tuple<char, int, double>;
+
+    SpscQueue<Tuple, 2> queue{};
+
+    const char v1{ 8 };
+    const int v2{ 13 };
+    const double v3{ 62 };
+    queue.emplace(v1, v2, v3);
+
+    Tuple front{};
+    ASSERT_TRUE(queue.try_pop(front));
+    ASSERT_EQ(std::make_tuple(v1, v2, v3), front) << "Expecting the emplace-ed element to pop up\n";
+}
+
+TEST(SpscQueueTests, ReleaseRemainingElements)
+{
+    const auto tracker = std::make_shared<int>(0);
+    {
+        SpscQueue<std::shared_ptr<int>, 4> queue{};
+        queue.push(tracker);
+        queue.push(tracker);
+    }
+
+    ASSERT_EQ(1, tracker.use_count()) << "Expecting a queue to destroy elements left behind\n";
+}
+
+TEST(SpscQueueTests, ProducerConsumerTransfer)
+{
+    constexpr int kCount{ 100000 };
+    SpscQueue<int, 64> queue{};
+    bool ordered{ true };
+    {
+        ThreadStorage threads{ 2u };
+        threads[0] = std::thread{ [&queue]()
+        {
+            for (int i{ 0 }; i < kCount; ++i)
+            {
+                queue.push(i);
+            }
+        } };
+        threads[1] = std::thread{ [&queue, &ordered]()
+        {
+            for (int i{ 0 }; i < kCount; ++i)
+            {
+                int value{};
+                queue.wait_and_pop(value);
+                ordered = ordered && (value == i);
+            }
+        } };
+    }
+
+    ASSERT_TRUE(ordered) << "Expecting elements to wrap around the ring in order\n";
+    ASSERT_TRUE(queue.empty()) << "Expecting a queue to be drained\n";
+}
+
+TEST(LockFreeQueueTests, DefaultConstruction)
+{
+    LockFreeQueue<int> queue{};
+
+    ASSERT_TRUE(queue.empty()) << "Expecting a fresh queue to be empty\n";
+}
+
+TEST(LockFreeQueueTests, Push)
+{
+    LockFreeQueue<int> queue{};
+
+    const int v1{ 8 }, v2{ 13 }, v3{ 62 };
+    queue.push(v1);
+    queue.push(v2);
+    queue.push(v3);
+
+    const LockFreeQueue<int> reference = { v1, v2, v3 };
+    ASSERT_EQ(queue, reference) << "Expecting a queue to hold all pushed elements\n";
+    ASSERT_EQ(3, queue.size()) << "Expecting a queue to count all pushed elements\n";
+}
+
+TEST(LockFreeQueueTests, ParallelPush)
+{
+    constexpr int v1{ 8 }, v2{ 13 };
+    LockFreeQueue<int> queue{};
+    {
+        ThreadStorage threads{ 2u };
+        threads[0] = std::thread{ [v1, &queue]()
+        {
+            queue.push(v1);
+        } };
+        threads[1] = std::thread{ [v2, &queue]()
+        {
+            queue.push(v2);
+        } };
+    }
+
+    const LockFreeQueue<int> reference1 = { v1, v2 };
+    const LockFreeQueue<int> reference2 = { v2, v1 };
+    ASSERT_TRUE(queue == reference1 || queue == reference2)
+        << "Expecting a queue to contain all pushed elements\n";
+}
+
+TEST(LockFreeQueueTests, Emplace)
+{
+    using Tuple = std::tuple<char, int, double>;
+
+    LockFreeQueue<Tuple> queue{};
+
+    const char v1{ 8 };
+    const int v2{ 13 };
+    const double v3{ 62 };
+    queue.emplace(v1, v2, v3);
+
+    const LockFreeQueue<Tuple> reference = { std::make_tuple(v1, v2, v3) };
+    ASSERT_EQ(queue, reference) << "Expecting a queue to hold the emplace-ed element\n";
+}
+
+TEST(LockFreeQueueTests, FilledValueTryPop)
+{
+    constexpr int v1{ 8 }, v2{ 13 }, v3{ 62 };
+    LockFreeQueue<int> queue = { v1, v2, v3 };
+
+    const auto p1 = queue.try_pop();
+    const auto p2 = queue.try_pop();
+    const auto p3 = queue.try_pop();
+    const auto p4 = queue.try_pop();
+
+    ASSERT_EQ(*p1, v1) << "Expecting the first element to show up first\n";
+    ASSERT_EQ(*p2, v2) << "Expecting the second element to show up second\n";
+    ASSERT_EQ(*p3, v3) << "Expecting the third element to show up third\n";
+    ASSERT_FALSE(p4) << "Expecting an empty queue afterwards\n";
+}
+
+TEST(LockFreeQueueTests, ParallelRefTryPop)
+{
+    constexpr int v1{ 7 }, v2{ 8 }, v3{ 9 }, v4{ 10 };
+    LockFreeQueue<int> queue = { 1, 2, 3, 4, 5, 6, v1, v2, v3, v4 };
+    {
+        ThreadStorage threads{ 3u };
+        threads[0] = std::thread{ [&queue]()
+        {
+            int dummy{};
+            queue.try_pop(dummy);
+        } };
+        threads[1] = std::thread{ [&queue]()
+        {
+            int dummy{};
+            queue.try_pop(dummy);
+            queue.try_pop(dummy);
+            queue.try_pop(dummy);
+        } };
+        threads[2] = std::thread{ [&queue]()
+        {
+            int dummy{};
+            queue.try_pop(dummy);
+            queue.try_pop(dummy);
+        } };
+    }
+
+    const LockFreeQueue<int> reference = { v1, v2, v3, v4 };
+    ASSERT_EQ(queue, reference) << "Expecting 4 elements to survive after parallel pops\n";
+}
+
+TEST(LockFreeQueueTests, PushAndWaitRefPop)
+{
+    LockFreeQueue<int> queue{};
+    {
+        ThreadStorage threads{ 3u };
+        threads[0] = std::thread{ [&queue]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            queue.push(8);
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            queue.push(13);
+        } };
+        threads[1] = std::thread{ [&queue]()
+        {
+            int dummy{};
+            queue.wait_and_pop(dummy);
+        } };
+        threads[2] = std::thread{ [&queue]()
+        {
+            queue.wait_and_pop();
+        } };
+    }
+
+    ASSERT_TRUE(queue.empty()) << "Expecting a queue to be totally empty\n";
+}
+
+TEST(LockFreeQueueTests, ParallelProducersAndConsumers)
+{
+    constexpr int kThreads{ 4 };
+    constexpr int kPerThread{ 20000 };
+    LockFreeQueue<int> queue{};
+    std::atomic<long long> total{ 0 };
+    {
+        ThreadStorage threads{ 2 * kThreads };
+        for (int t{ 0 }; t < kThreads; ++t)
+        {
+            threads[t] = std::thread{ [&queue]()
+            {
+                for (int i{ 1 }; i <= kPerThread; ++i)
+                {
+                    queue.push(i);
+                }
+            } };
+            threads[kThreads + t] = std::thread{ [&queue, &total]()
+            {
+                long long sum{ 0 };
+                for (int i{ 0 }; i < kPerThread; ++i)
+                {
+                    int value{};
+                    queue.wait_and_pop(value);
+                    sum += value;
+                }
+                total += sum;
+            } };
+        }
+    }
+
+    constexpr long long expected{ kThreads * (kPerThread * (kPerThread + 1LL) / 2) };
+    ASSERT_EQ(expected, total.load()) << "Expecting every pushed element to be popped exactly once\n";
+    ASSERT_TRUE(queue.empty()) << "Expecting a queue to be drained\n";
+}
+
+TEST(LockFreeQueueTests, CopyConstruction)
+{
+    std::initializer_list<int> values = { 8, 13, 62 };
+    const LockFreeQueue<int> donor = values;
+
+    const LockFreeQueue<int> copy{ donor };
+
+    const LockFreeQueue<int> reference = values;
+    ASSERT_EQ(reference, copy) << "Expecting a copy to fully resemble the donor\n";
+}
+
+TEST(LockFreeQueueTests, MoveConstruction)
+{
+    std::initializer_list<int> values = { 8, 13, 62 };
+    LockFreeQueue<int> donor = values;
+
+    static_assert(std::is_nothrow_move_constructible_v<LockFreeQueue<int>>);
+    LockFreeQueue<int> moved{ std::move(donor) };
+
+    const LockFreeQueue<int> reference = values;
+    ASSERT_EQ(reference, moved) << "Expecting a moved to take over the elements of the donor\n";
+    ASSERT_EQ(values.size(), moved.size()) << "Expecting a moved to take over the size of the donor\n";
+
+    donor = LockFreeQueue<int>{ 5 };
+    const LockFreeQueue<int> assigned = { 5 };
+    ASSERT_EQ(assigned, donor) << "Expecting a moved from queue to accept an assignment\n";
+}
+
+TEST(LockFreeQueueTests, MoveAssigned)
+{
+    std::initializer_list<int> ref = { 8, 13, 62 };
+    LockFreeQueue<int> queue{ 1, 2, 3 };
+
+    queue = std::move(LockFreeQueue<int>{ ref });
+
+    const LockFreeQueue<int> reference{ ref };
+    ASSERT_EQ(queue, reference)
+        << "Expecting a queue to absorb all elements of the donor\n";
+}
+
+TEST(LockFreeQueueTests, Swap)
+{
+    std::initializer_list<int> init1{ 8, 13, 62 };
+    LockFreeQueue<int> queue1{ init1 };
+    std::initializer_list<int> init2{ 62, 13 };
+    LockFreeQueue<int> queue2{ init2 };
+
+    queue1.swap(queue2);
+
+    const LockFreeQueue<int> reference1{ init2 };
+    const LockFreeQueue<int> reference2{ init1 };
+    ASSERT_EQ(queue1, reference1) << "Expecting a queue to grab partner's elements";
+    ASSERT_EQ(queue2, reference2) << "Expecting a queue to grab partner's elements";
+    ASSERT_EQ(2, queue1.size()) << "Expecting a size to travel along with elements";
+}
+
+TEST(FineQueueTests, PooledPushAndTryPop)
+{
+    constexpr int v1{ 8 }, v2{ 13 }, v3{ 62 };
+    FineQueue<int, PooledElements> queue{};
+    queue.push(v1);
+    queue.emplace(v2);
+    queue.push(v3);
+
+    int p1{};
+    const bool responce = queue.try_pop(p1);
+    const auto p2 = queue.try_pop();
+    const auto p3 = queue.wait_and_pop();
+
+    ASSERT_TRUE(responce) << "Expecting a successful attempt to pop from a filled queue\n";
+    ASSERT_EQ(p1, v1) << "Expecting the first element to show up first\n";
+    ASSERT_EQ(*p2, v2) << "Expecting the second element to show up second\n";
+    ASSERT_EQ(*p3, v3) << "Expecting the third element to show up third\n";
+    ASSERT_TRUE(queue.empty()) << "Expecting an empty queue afterwards\n";
+}
+
+TEST(FineQueueTests, PooledNodesReuse)
+{
+    FineQueue<std::unique_ptr<int>, PooledElements> queue{};
+
+    // Drain and refill the queue many times over to cycle nodes through the pool
+    for (int round{ 0 }; round < 100; ++round)
+    {
+        for (int i{ 0 }; i < 10; ++i)
+        {
+            queue.push(std::make_unique<int>(round * 10 + i));
+        }
+        for (int i{ 0 }; i < 10; ++i)
+        {
+            std::unique_ptr<int> front{};
+            ASSERT_TRUE(queue.try_pop(front));
+            ASSERT_EQ(round * 10 + i, *front) << "Expecting recycled nodes to preserve the order\n";
+        }
+    }
+
+    ASSERT_TRUE(queue.empty()) << "Expecting a queue to be drained\n";
+}
+
+TEST(FineQueueTests, PooledCopyAndCompare)
+{
+    std::initializer_list<int> values = { 8, 13, 62 };
+    FineQueue<int, PooledElements> donor = values;
+    donor.push(4);
+    int dummy{};
+    donor.try_pop(dummy);
+
+    const FineQueue<int, PooledElements> copy{ donor };
+
+    const FineQueue<int, PooledElements> reference = { 13, 62, 4 };
+    ASSERT_EQ(reference, copy) << "Expecting a copy to fully resemble the donor\n";
+    ASSERT_EQ(3, copy.size()) << "Expecting a copy to hold all elements of the donor\n";
+}
+
+TEST(FineQueueTests, PooledParallelProducersAndConsumers)
+{
+    constexpr int kThreads{ 4 };
+    constexpr int kPerThread{ 20000 };
+    FineQueue<int, PooledElements> queue{};
+    std::atomic<long long> total{ 0 };
+    {
+        ThreadStorage threads{ 2 * kThreads };
+        for (int t{ 0 }; t < kThreads; ++t)
+        {
+            threads[t] = std::thread{ [&queue]()
+            {
+                for (int i{ 1 }; i <= kPerThread; ++i)
+                {
+                    queue.push(i);
+                }
+            } };
+            threads[kThreads + t] = std::thread{ [&queue, &total]()
+            {
+                long long sum{ 0 };
+                for (int i{ 0 }; i < kPerThread; ++i)
+                {
+                    int value{};
+                    queue.wait_and_pop(value);
+                    sum += value;
+                }
+                total += sum;
+            } };
+        }
+    }
+
+    constexpr long long expected{ kThreads * (kPerThread * (kPerThread + 1LL) / 2) };
+    ASSERT_EQ(expected, total.load()) << "Expecting every pushed element to be popped exactly once\n";
+    ASSERT_TRUE(queue.empty()) << "Expecting a queue to be drained\n";
+}
+
+
+TEST(FineQueueTests, PushRangeAndTryPopBulk)
+{
+    const std::vector<int> values{ 4, 8, 15, 16, 23, 42 };
+    FineQueue<int> queue{ 1 };
+
+    const auto pushed = queue.push_range(values.cbegin(), values.cend());
+
+    int front{};
+    queue.try_pop(front);
+    std::vector<int> popped{};
+    const auto first = queue.try_pop_bulk(std::back_inserter(popped), 4);
+    const auto second = queue.try_pop_bulk(std::back_inserter(popped), 4);
+
+    ASSERT_EQ(values.size(), pushed) << "Expecting a queue to accept the whole range\n";
+    ASSERT_EQ(1, front) << "Expecting a batch to be spliced after existing elements\n";
+    ASSERT_EQ(4, first) << "Expecting a bulk pop to be limited by the requested number\n";
+    ASSERT_EQ(2, second) << "Expecting a bulk pop to be limited by available elements\n";
+    ASSERT_EQ(values, popped) << "Expecting a batch to preserve the order\n";
+    ASSERT_TRUE(queue.empty()) << "Expecting an empty queue afterwards\n";
+}
+
+TEST(FineQueueTests, PooledPushBulkAndWaitPopBulk)
+{
+    std::vector<std::unique_ptr<int>> values{};
+    for (int i{ 0 }; i < 100; ++i)
+    {
+        values.push_back(std::make_unique<int>(i));
+    }
+    FineQueue<std::unique_ptr<int>, PooledElements> queue{};
+
+    std::vector<std::unique_ptr<int>> popped{};
+    {
+        ThreadStorage threads{ 2u };
+        threads[0] = std::thread{ [&queue, &values]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            queue.push_bulk(values);
+        } };
+        threads[1] = std::thread{ [&queue, &popped]()
+        {
+            while (popped.size() < 100)
+            {
+                queue.wait_and_pop_bulk(std::back_inserter(popped), 16);
+            }
+        } };
+    }
+
+    bool ordered{ true };
+    for (int i{ 0 }; i < 100; ++i)
+    {
+        ordered = ordered && (*popped[i] == i);
+    }
+    ASSERT_TRUE(ordered) << "Expecting a batch to pass through a pooled queue in order\n";
+    ASSERT_TRUE(queue.empty()) << "Expecting an empty queue afterwards\n";
+}
+
+TEST(FineQueueTests, EmptyPushRange)
+{
+    const std::vector<int> values{};
+    FineQueue<int> queue{};
+
+    const auto pushed = queue.push_range(values.cbegin(), values.cend());
+
+    ASSERT_EQ(0, pushed) << "Expecting nothing to be pushed from an empty range\n";
+    ASSERT_TRUE(queue.empty()) << "Expecting a queue to stay empty\n";
+}
+// Passing elements from several producers to as many consumers through a queue, which blocks either side
+constexpr int kTransferThreads{ 2 };
+
+template <typename Queue>
+long long transfer_in_parallel(Queue& queue, const int perThread)
+{
+    constexpr int kThreads{ kTransferThreads };
+    std::atomic<long long> total{ 0 };
+    {
+        ThreadStorage threads{ 2 * kThreads };
+        for (int t{ 0 }; t < kThreads; ++t)
+        {
+            threads[t] = std::thread{ [&queue, perThread]()
+            {
+                for (int i{ 1 }; i <= perThread; ++i)
+                {
+                    queue.push(i);
+                }
+            } };
+            threads[kThreads + t] = std::thread{ [&queue, &total, perThread]()
+            {
+                long long sum{ 0 };
+                for (int i{ 0 }; i < perThread; ++i)
+                {
+                    int value{};
+                    queue.wait_and_pop(value);
+                    sum += value;
+                }
+                total += sum;
+            } };
+        }
+    }
+    return total.load();
+}
+
+constexpr long long transferred_total(const int perThread)
+{
+    return kTransferThreads * (perThread * (perThread + 1LL) / 2);
+}
+
+TEST(WaitPoliciesTests, SpinWaitTransfer)
+{
+    BluntQueue<int, SpinWait> blunt{ QueueCapacity{ 4 } };
+    FineQueue<int, SharedElements, SpinWait> fine{};
+    LockFreeQueue<int, SpinWait> lockFree{};
+
+    // Spinners burn whole time slices, when threads outnumber cores, so keep the transfer short
+    constexpr int kPerThread{ 200 };
+
+    ASSERT_EQ(transferred_total(kPerThread), transfer_in_parallel(blunt, kPerThread)) << "Expecting a spinning BluntQueue to pass all elements\n";
+    ASSERT_EQ(transferred_total(kPerThread), transfer_in_parallel(fine, kPerThread)) << "Expecting a spinning FineQueue to pass all elements\n";
+    ASSERT_EQ(transferred_total(kPerThread), transfer_in_parallel(lockFree, kPerThread))
+        << "Expecting a spinning LockFreeQueue to pass all elements\n";
+}
+
+TEST(WaitPoliciesTests, SpinBlockWaitTransfer)
+{
+    // Few spins make waiters fall asleep often
+    BluntQueue<int, SpinBlockWait<16>> blunt{ QueueCapacity{ 4 } };
+    FineQueue<int, PooledElements, SpinBlockWait<16>> fine{};
+    LockFreeQueue<int, SpinBlockWait<16>> lockFree{};
+
+    ASSERT_EQ(transferred_total(5000), transfer_in_parallel(blunt, 5000)) << "Expecting a hybrid BluntQueue to pass all elements\n";
+    ASSERT_EQ(transferred_total(5000), transfer_in_parallel(fine, 5000)) << "Expecting a hybrid FineQueue to pass all elements\n";
+    ASSERT_EQ(transferred_total(5000), transfer_in_parallel(lockFree, 5000))
+        << "Expecting a hybrid LockFreeQueue to pass all elements\n";
+}
+
+TEST(WaitPoliciesTests, AtomicWaitTransfer)
+{
+    BluntQueue<int, AtomicWait> blunt{ QueueCapacity{ 4 } };
+    FineQueue<int, SharedElements, AtomicWait> fine{};
+    LockFreeQueue<int, AtomicWait> lockFree{};
+
+    ASSERT_EQ(transferred_total(5000), transfer_in_parallel(blunt, 5000)) << "Expecting an atomic waiting BluntQueue to pass all elements\n";
+    ASSERT_EQ(transferred_total(5000), transfer_in_parallel(fine, 5000)) << "Expecting an atomic waiting FineQueue to pass all elements\n";
+    ASSERT_EQ(transferred_total(5000), transfer_in_parallel(lockFree, 5000))
+        << "Expecting an atomic waiting LockFreeQueue to pass all elements\n";
+}
+
+TEST(WaitPoliciesTests, BlockWaitTransfer)
+{
+    BluntQueue<int> blunt{ QueueCapacity{ 4 } };
+    FineQueue<int> fine{};
+    LockFreeQueue<int> lockFree{};
+
+    ASSERT_EQ(transferred_total(5000), transfer_in_parallel(blunt, 5000)) << "Expecting a blocking BluntQueue to pass all elements\n";
+    ASSERT_EQ(transferred_total(5000), transfer_in_parallel(fine, 5000)) << "Expecting a blocking FineQueue to pass all elements\n";
+    ASSERT_EQ(transferred_total(5000), transfer_in_parallel(lockFree, 5000))
+        << "Expecting a blocking LockFreeQueue to pass all elements\n";
+}
+
+TEST(WaitPoliciesTests, SpinWaitCloseWakesConsumers)
+{
+    BluntQueue<int, SpinWait> queue{};
+    bool popped{ true };
+    {
+        ThreadStorage threads{ 2u };
+        threads[0] = std::thread{ [&queue, &popped]()
+        {
+            int front{};
+            popped = queue.wait_and_pop(front);
+        } };
+        threads[1] = std::thread{ [&queue]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            queue.close();
+        } };
+    }
+
+    ASSERT_FALSE(popped) << "Expecting a spinning consumer to give up on a closed BluntQueue\n";
+}
+
+TEST(ChunkedQueueTests, DefaultConstruction)
+{
+    ChunkedQueue<int> queue{};
+
+    ASSERT_TRUE(queue.empty()) << "Expecting a fresh queue to be empty\n";
+    ASSERT_EQ(0, queue.size()) << "Expecting a fresh queue to hold nothing\n";
+}
+
+TEST(ChunkedQueueTests, PushAcrossChunks)
+{
+    ChunkedQueue<int, 4> queue{};
+    for (int i{ 0 }; i < 10; ++i)
+    {
+        queue.push(i);
+    }
+
+    const ChunkedQueue<int, 4> reference = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    ASSERT_EQ(queue, reference) << "Expecting a queue to hold all pushed elements\n";
+    ASSERT_EQ(10, queue.size()) << "Expecting a queue to count all pushed elements\n";
+}
+
+TEST(ChunkedQueueTests, Emplace)
+{
+    using Tuple = std::tuple<char, int, double>;
+
+    ChunkedQueue<Tuple> queue{};
+
+    const char v1{ 8 };
+    const int v2{ 13 };
+    const double v3{ 62 };
+    queue.emplace(v1, v2, v3);
+
+    const ChunkedQueue<Tuple> reference = { std::make_tuple(v1, v2, v3) };
+    ASSERT_EQ(queue, reference) << "Expecting a queue to hold the emplace-ed element\n";
+}
+
+TEST(ChunkedQueueTests, TryPopAcrossChunks)
+{
+    ChunkedQueue<int, 2> queue = { 1, 2, 3, 4, 5 };
+
+    int value{};
+    ASSERT_TRUE(queue.try_pop(value));
+    ASSERT_EQ(1, value) << "Expecting the first element to show up first\n";
+    const auto second = queue.try_pop();
+    ASSERT_EQ(2, *second) << "Expecting the second element to show up second\n";
+    ASSERT_TRUE(queue.try_pop(value));
+    ASSERT_EQ(3, value) << "Expecting a pop to move on to the next chunk\n";
+
+    queue.push(6);
+    ASSERT_EQ(3, queue.size()) << "Expecting a queue to count remaining elements\n";
+    ASSERT_TRUE(queue.try_pop(value));
+    ASSERT_TRUE(queue.try_pop(value));
+    ASSERT_TRUE(queue.try_pop(value));
+    ASSERT_EQ(6, value) << "Expecting a queue to preserve the order across chunks\n";
+    ASSERT_FALSE(queue.try_pop(value)) << "Expecting an empty queue afterwards\n";
+    ASSERT_FALSE(queue.try_pop()) << "Expecting an empty queue afterwards\n";
+}
+
+TEST(ChunkedQueueTests, ReleaseRemainingElements)
+{
+    const auto tracker = std::make_shared<int>(0);
+    {
+        ChunkedQueue<std::shared_ptr<int>, 2> queue{};
+        for (int i{ 0 }; i < 5; ++i)
+        {
+            queue.push(tracker);
+        }
+        std::shared_ptr<int> front{};
+        queue.try_pop(front);
+    }
+
+    ASSERT_EQ(1, tracker.use_count()) << "Expecting a queue to destroy remaining elements\n";
+}
+
+TEST(ChunkedQueueTests, CopyMoveAndSwap)
+{
+    ChunkedQueue<int, 2> original = { 1, 2, 3 };
+    int value{};
+    original.try_pop(value);
+
+    const ChunkedQueue<int, 2> copy{ original };
+    const ChunkedQueue<int, 2> reference = { 2, 3 };
+    ASSERT_EQ(reference, copy) << "Expecting a copy to start at the head of a source\n";
+
+    static_assert(std::is_nothrow_move_constructible_v<ChunkedQueue<int, 2>>);
+    ChunkedQueue<int, 2> moved{ std::move(original) };
+    ASSERT_EQ(reference, moved) << "Expecting a moved to take over the elements of the source\n";
+    ASSERT_EQ(2, moved.size()) << "Expecting a moved to take over the size of the source\n";
+
+    original = ChunkedQueue<int, 2>{ 4 };
+    const ChunkedQueue<int, 2> assigned = { 4 };
+    ASSERT_EQ(assigned, original) << "Expecting a moved from queue to accept an assignment\n";
+
+    ChunkedQueue<int, 2> other = { 7 };
+    moved.swap(other);
+
+    const ChunkedQueue<int, 2> single = { 7 };
+    ASSERT_EQ(single, moved) << "Expecting a swap to exchange contents\n";
+    ASSERT_EQ(reference, other) << "Expecting a swap to exchange contents\n";
+    ASSERT_EQ(2, other.size()) << "Expecting a swap to exchange sizes\n";
+}
+
+TEST(ChunkedQueueTests, PushRangeAndPopBulk)
+{
+    std::vector<int> values(100);
+    for (int i{ 0 }; i < 100; ++i)
+    {
+        values[i] = i;
+    }
+    ChunkedQueue<int, 8> queue{};
+
+    const auto pushed = queue.push_bulk(values);
+    std::vector<int> popped{};
+    const auto first = queue.try_pop_bulk(std::back_inserter(popped), 30);
+    const auto second = queue.wait_and_pop_bulk(std::back_inserter(popped), 100);
+
+    ASSERT_EQ(100, pushed) << "Expecting a whole batch to be pushed\n";
+    ASSERT_EQ(30, first) << "Expecting a bulk pop to stop at the given count\n";
+    ASSERT_EQ(70, second) << "Expecting a bulk pop to stop at the end of a queue\n";
+    ASSERT_EQ(values, popped) << "Expecting a batch to pass through a queue in order\n";
+    ASSERT_TRUE(queue.empty()) << "Expecting an empty queue afterwards\n";
+}
+
+TEST(ChunkedQueueTests, ParallelProducersAndConsumers)
+{
+    ChunkedQueue<int, 16> queue{};
+
+    ASSERT_EQ(transferred_total(5000), transfer_in_parallel(queue, 5000))
+        << "Expecting every pushed element to be popped exactly once\n";
+    ASSERT_TRUE(queue.empty()) << "Expecting a queue to be drained\n";
+}
+
+TEST(QueueStatsTests, NoStatsTakeNoRoom)
+{
+    ASSERT_TRUE(std::is_empty_v<NoStats>) << "Expecting disabled stats to hold no state\n";
+    ASSERT_EQ(sizeof(BluntQueue<int>), sizeof(BluntQueue<int, BlockWait, NoStats>))
+        << "Expecting disabled stats to be the default\n";
+}
+
+TEST(QueueStatsTests, BluntQueueTraffic)
+{
+    BluntQueue<int, BlockWait, ContentionStats> queue{};
+    queue.push(1);
+    queue.push(2);
+    queue.push(3);
+    int value{};
+    queue.try_pop(value);
+    queue.wait_and_pop(value);
+
+    const QueueStatsSnapshot stats{ queue.stats().snapshot() };
+    const LockStats& lock{ stats.locks_[static_cast<std::size_t>(LockSite::Storage)] };
+    ASSERT_EQ(3, stats.pushes_) << "Expecting every push to be counted\n";
+    ASSERT_EQ(2, stats.pops_) << "Expecting every pop to be counted\n";
+    ASSERT_EQ(3, stats.highWaterMark_) << "Expecting the deepest point to be remembered\n";
+    ASSERT_EQ(5, lock.acquisitions_) << "Expecting every acquisition of the mutex to be counted\n";
+    ASSERT_EQ(0, lock.contentions_) << "Expecting a single thread to never contend\n";
+    ASSERT_EQ(1, std::accumulate(stats.latency_.cbegin(), stats.latency_.cend(), std::uint64_t{ 0 }))
+        << "Expecting the probe element to be measured once popped\n";
+}
+
+TEST(QueueStatsTests, BluntQueueBlockedPop)
+{
+    BluntQueue<int, BlockWait, ContentionStats> queue{};
+    {
+        ThreadStorage threads{ 2u };
+        threads[0] = std::thread{ [&queue]()
+        {
+            int value{};
+            queue.wait_and_pop(value);
+        } };
+        threads[1] = std::thread{ [&queue]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            queue.push(1);
+        } };
+    }
+
+    const QueueStatsSnapshot stats{ queue.stats().snapshot() };
+    ASSERT_GE(stats.blocked_[static_cast<std::size_t>(WaitSite::Pop)], std::chrono::milliseconds(100))
+        << "Expecting the time a consumer has been blocked for to be accounted\n";
+    ASSERT_EQ(0, stats.blocked_[static_cast<std::size_t>(WaitSite::Push)].count())
+        << "Expecting unbounded producers to never block\n";
+}
+
+TEST(QueueStatsTests, FineQueueTraffic)
+{
+    const std::vector<int> values{ 1, 2, 3, 4 };
+    FineQueue<int, PooledElements, BlockWait, ContentionStats> queue = { 0 };
+    queue.push_range(values.cbegin(), values.cend());
+    std::vector<int> popped{};
+    queue.try_pop_bulk(std::back_inserter(popped), 3);
+
+    const QueueStatsSnapshot stats{ queue.stats().snapshot() };
+    ASSERT_EQ(5, stats.pushes_) << "Expecting initial and batched elements to be counted\n";
+    ASSERT_EQ(3, stats.pops_) << "Expecting bulk popped elements to be counted\n";
+    ASSERT_EQ(5, stats.highWaterMark_) << "Expecting the deepest point to be remembered\n";
+    ASSERT_GT(stats.locks_[static_cast<std::size_t>(LockSite::Head)].acquisitions_, 0)
+        << "Expecting the head mutex to be accounted\n";
+    ASSERT_GT(stats.locks_[static_cast<std::size_t>(LockSite::Tail)].acquisitions_, 0)
+        << "Expecting the tail mutex to be accounted\n";
+}
+
+TEST(QueueStatsTests, FineQueueParallelTraffic)
+{
+    FineQueue<int, SharedElements, BlockWait, ContentionStats> queue{};
+
+    ASSERT_EQ(transferred_total(5000), transfer_in_parallel(queue, 5000));
+
+    const QueueStatsSnapshot stats{ queue.stats().snapshot() };
+    const LockStats& head{ stats.locks_[static_cast<std::size_t>(LockSite::Head)] };
+    ASSERT_EQ(10000, stats.pushes_) << "Expecting every push to be counted\n";
+    ASSERT_EQ(10000, stats.pops_) << "Expecting every pop to be counted\n";
+    ASSERT_LE(head.contentions_, head.acquisitions_) << "Expecting contentions to be a share of acquisitions\n";
+    ASSERT_GT(std::accumulate(stats.latency_.cbegin(), stats.latency_.cend(), std::uint64_t{ 0 }), 0)
+        << "Expecting latencies to be sampled\n";
+}
+
+TEST(ShardedQueueTests, ShardCount)
+{
+    const ShardedQueue<int> relaxed{ 4 };
+    const ShardedQueue<int> strict{ 4, ShardOrdering::Strict };
+    const ShardedQueue<int, BluntQueue<int>> none{ 0 };
+
+    ASSERT_EQ(4, relaxed.shard_count()) << "Expecting the requested number of shards\n";
+    ASSERT_EQ(1, strict.shard_count()) << "Expecting a strict queue to fall back to a single shard\n";
+    ASSERT_EQ(1, none.shard_count()) << "Expecting at least a single shard\n";
+    ASSERT_TRUE(relaxed.empty()) << "Expecting a fresh queue to be empty\n";
+}
+
+TEST(ShardedQueueTests, SingleThreadPushAndTryPop)
+{
+    ShardedQueue<int> queue{ 4 };
+    queue.push(1);
+    queue.emplace(2);
+    queue.push(3);
+
+    int first{}, second{};
+    ASSERT_EQ(3, queue.size()) << "Expecting a queue to count pushed elements\n";
+    ASSERT_TRUE(queue.try_pop(first));
+    ASSERT_TRUE(queue.try_pop(second));
+    const auto third = queue.try_pop();
+    ASSERT_TRUE(third);
+    ASSERT_FALSE(queue.try_pop()) << "Expecting an empty queue afterwards\n";
+    ASSERT_EQ(1, first) << "Expecting a thread to see its own elements in order\n";
+    ASSERT_EQ(2, second) << "Expecting a thread to see its own elements in order\n";
+    ASSERT_EQ(3, *third) << "Expecting a thread to see its own elements in order\n";
+}
+
+TEST(ShardedQueueTests, PopFromForeignShard)
+{
+    ShardedQueue<int, BluntQueue<int>> queue{ 8 };
+    {
+        ThreadStorage threads{ 1u };
+        threads[0] = std::thread{ [&queue]()
+        {
+            queue.push(42);
+        } };
+    }
+
+    int value{};
+    ASSERT_TRUE(queue.try_pop(value)) << "Expecting a consumer to scan shards of other threads\n";
+    ASSERT_EQ(42, value);
+}
+
+TEST(ShardedQueueTests, StrictOrdering)
+{
+    ShardedQueue<int> queue{ 4, ShardOrdering::Strict };
+    {
+        ThreadStorage threads{ 1u };
+        threads[0] = std::thread{ [&queue]()
+        {
+            queue.push(1);
+        } };
+    }
+    queue.push(2);
+
+    int first{}, second{};
+    queue.try_pop(first);
+    queue.try_pop(second);
+    ASSERT_EQ(1, first) << "Expecting a strict queue to keep the order across threads\n";
+    ASSERT_EQ(2, second) << "Expecting a strict queue to keep the order across threads\n";
+}
+
+TEST(ShardedQueueTests, PushAndWaitPop)
+{
+    ShardedQueue<int> queue{ 4 };
+    std::shared_ptr<int> value{};
+    {
+        ThreadStorage threads{ 2u };
+        threads[0] = std::thread{ [&queue, &value]()
+        {
+            value = queue.wait_and_pop();
+        } };
+        threads[1] = std::thread{ [&queue]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            queue.push(7);
+        } };
+    }
+
+    ASSERT_TRUE(value) << "Expecting a waiting consumer to receive an element\n";
+    ASSERT_EQ(7, *value);
+}
+
+TEST(ShardedQueueTests, ParallelProducersAndConsumers)
+{
+    ShardedQueue<int> queue{ 3 };
+
+    ASSERT_EQ(transferred_total(5000), transfer_in_parallel(queue, 5000))
+        << "Expecting every pushed element to be popped exactly once\n";
+    ASSERT_TRUE(queue.empty()) << "Expecting a queue to be drained\n";
+}
+
+TEST(ThreadPoolTests, SubmitReturnsResult)
+{
+    ThreadPool pool{ 2u };
+    std::future<int> answer{ pool.submit([]() { return 42; }) };
+
+    ASSERT_EQ(2u, pool.size()) << "Expecting the requested number of workers\n";
+    ASSERT_EQ(42, answer.get()) << "Expecting a future to deliver a result of a task\n";
+}
+
+TEST(ThreadPoolTests, SubmitMoveOnlyTask)
+{
+    ThreadPool pool{ 1u };
+    auto value = std::make_unique<int>(7);
+    std::future<int> result{ pool.submit([value = std::move(value)]() { return *value; }) };
+
+    ASSERT_EQ(7, result.get()) << "Expecting a pool to accept move-only callables\n";
+}
+
+TEST(ThreadPoolTests, SubmitPropagatesException)
+{
+    ThreadPool pool{ 1u };
+    std::future<void> failure{ pool.submit([]() { throw std::logic_error{ "failure" }; }) };
+    std::future<int> success{ pool.submit([]() { return 1; }) };
+
+    ASSERT_THROW(failure.get(), std::logic_error) << "Expecting a future to rethrow an exception of a task\n";
+    ASSERT_EQ(1, success.get()) << "Expecting a worker to survive a failed task\n";
+}
+
+TEST(ThreadPoolTests, ManyTasks)
+{
+    constexpr int kTasks{ 1000 };
+
+    ThreadPool pool{ 3u };
+    std::vector<std::future<int>> results{};
+    for (int t{ 1 }; t <= kTasks; ++t)
+    {
+        results.push_back(pool.submit([t]() { return t; }));
+    }
+
+    long long sum{ 0 };
+    for (std::future<int>& result : results)
+    {
+        sum += result.get();
+    }
+    ASSERT_EQ(kTasks * (kTasks + 1LL) / 2, sum) << "Expecting every task to be run exactly once\n";
+}
+
+TEST(ThreadPoolTests, ShutdownDrainsTasks)
+{
+    std::atomic<int> completed{ 0 };
+    ThreadPool pool{ 2u };
+    for (int t{ 0 }; t < 100; ++t)
+    {
+        pool.submit([&completed]()
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            ++completed;
+        });
+    }
+    pool.shutdown();
+
+    ASSERT_EQ(100, completed.load()) << "Expecting a shutdown to complete queued tasks\n";
+    ASSERT_THROW(pool.submit([]() {}), std::runtime_error) << "Expecting a shut down pool to reject tasks\n";
+}
+
+// Fork-join summation of [first, last), whose tasks help running subtasks instead of blocking workers
+long long sum_in_pool(ThreadPool& pool, const int first, const int last)
+{
+    if (last - first <= 16)
+    {
+        long long sum{ 0 };
+        for (int i{ first }; i < last; ++i)
+        {
+            sum += i;
+        }
+        return sum;
+    }
+
+    const int middle{ first + (last - first) / 2 };
+    std::future<long long> left{ pool.submit([&pool, first, middle]() { return sum_in_pool(pool, first, middle); }) };
+    const long long right{ sum_in_pool(pool, middle, last) };
+    while (left.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        if (!pool.run_pending_task())
+        {
+            std::this_thread::yield();
+        }
+    }
+    return left.get() + right;
+}
+
+TEST(ThreadPoolTests, ForkJoin)
+{
+    constexpr int kCount{ 20000 };
+
+    ThreadPool pool{ 3u };
+    std::future<long long> sum{ pool.submit([&pool]() { return sum_in_pool(pool, 0, kCount); }) };
+
+    ASSERT_EQ(kCount * (kCount - 1LL) / 2, sum.get()) << "Expecting subtasks to be run exactly once\n";
+}
+
+TEST(ThreadPoolTests, ShutdownCompletesSpawnedTasks)
+{
+    std::atomic<int> completed{ 0 };
+    {
+        ThreadPool pool{ 2u };
+        for (int t{ 0 }; t < 10; ++t)
+        {
+            pool.submit([&pool, &completed]()
+            {
+                for (int s{ 0 }; s < 10; ++s)
+                {
+                    pool.submit([&completed]() { ++completed; });
+                }
+            });
+        }
+        pool.shutdown();
+    }
+
+    ASSERT_EQ(100, completed.load()) << "Expecting a shutdown to wait for tasks spawned by tasks\n";
+}
+
+TEST(WorkStealingDequeTests, OwnerLifoThiefFifo)
+{
+    WorkStealingDeque<int> deque{ 2 };
+    for (int i{ 1 }; i <= 5; ++i)
+    {
+        deque.push(i);
+    }
+
+    ASSERT_EQ(5, deque.size()) << "Expecting a deque to grow beyond its initial capacity\n";
+    ASSERT_EQ(5, deque.pop()) << "Expecting an owner to pop the most recent element\n";
+    ASSERT_EQ(1, deque.steal()) << "Expecting a thief to steal the oldest element\n";
+    ASSERT_EQ(4, deque.pop());
+    ASSERT_EQ(2, deque.steal());
+    ASSERT_EQ(3, deque.pop());
+    ASSERT_FALSE(deque.pop()) << "Expecting an empty deque afterwards\n";
+    ASSERT_FALSE(deque.steal()) << "Expecting an empty deque afterwards\n";
+    ASSERT_TRUE(deque.empty());
+}
+
+TEST(WorkStealingDequeTests, ConcurrentOwnerAndThieves)
+{
+    constexpr int kCount{ 20000 };
+    constexpr int kThieves{ 2 };
+
+    WorkStealingDeque<int> deque{};
+    std::atomic<long long> stolen{ 0 };
+    std::atomic<bool> done{ false };
+    long long popped{ 0 };
+    {
+        ThreadStorage threads{ kThieves + 1 };
+        threads[0] = std::thread{ [&deque, &popped, &done]()
+        {
+            for (int i{ 1 }; i <= kCount; ++i)
+            {
+                deque.push(i);
+                if (i % 3 == 0)
+                {
+                    popped += deque.pop().value_or(0);
+                }
+            }
+            while (const std::optional<int> value{ deque.pop() })
+            {
+                popped += *value;
+            }
+            done.store(true);
+        } };
+        for (int t{ 1 }; t <= kThieves; ++t)
+        {
+            threads[t] = std::thread{ [&deque, &stolen, &done]()
+            {
+                while (!done.load() || !deque.empty())
+                {
+                    stolen += deque.steal().value_or(0);
+                }
+            } };
+        }
+    }
+
+    ASSERT_EQ(kCount * (kCount + 1LL) / 2, popped + stolen.load()) << "Expecting every element to be taken exactly once\n";
+}
+
+// Two nodes of two processors each
+CpuTopology two_node_topology()
+{
+    return CpuTopology{ { NumaNode{ 0, { 0, 1 } }, NumaNode{ 1, { 2, 3 } } } };
+}
+
+TEST(ThreadPlacementTests, DetectTopology)
+{
+    const CpuTopology topology{ CpuTopology::detect() };
+
+    ASSERT_LE(1u, topology.node_count()) << "Expecting at least a single node\n";
+    ASSERT_LE(1u, topology.cpu_count()) << "Expecting at least a single processor\n";
+    ASSERT_EQ(1u, CpuTopology{ {} }.node_count()) << "Expecting an empty topology to fall back to a single node\n";
+}
+
+TEST(ThreadPlacementTests, CompactAndScatter)
+{
+    const ThreadPlacement compact{ PlacementMode::Compact, two_node_topology() };
+    const ThreadPlacement scatter{ PlacementMode::Scatter, two_node_topology() };
+    const ThreadPlacement floating{ PlacementMode::Floating, two_node_topology() };
+
+    ASSERT_EQ(1u, compact.cpu_for(1)) << "Expecting a compact placement to fill a node up first\n";
+    ASSERT_EQ(0u, compact.node_for(1));
+    ASSERT_EQ(2u, compact.cpu_for(2));
+    ASSERT_EQ(1u, compact.node_for(2));
+    ASSERT_EQ(0u, compact.cpu_for(4)) << "Expecting a placement to wrap around\n";
+    ASSERT_EQ(2u, scatter.cpu_for(1)) << "Expecting a scattered placement to alternate nodes\n";
+    ASSERT_EQ(1u, scatter.node_for(1));
+    ASSERT_EQ(1u, scatter.cpu_for(2));
+    ASSERT_EQ(0u, scatter.node_for(2));
+    ASSERT_FALSE(floating.cpu_for(0)) << "Expecting floating threads to be left to the scheduler\n";
+    ASSERT_EQ(1u, floating.node_for(1)) << "Expecting floating threads to be spread across nodes\n";
+    ASSERT_EQ(1u, compact.topology().node_of(3));
+}
+
+TEST(ThreadPlacementTests, PinnedThreadStorage)
+{
+    const ThreadPlacement placement{ PlacementMode::Compact };
+    const unsigned cpu{ *placement.cpu_for(0) };
+    bool pinned{ false };
+    std::optional<unsigned> current{};
+    {
+        ThreadStorage threads{ 1u, placement };
+        threads.start(0, [&pinned, &current]()
+        {
+            pinned = true;
+            current = ThreadPlacement::current_cpu();
+        });
+    }
+
+    ASSERT_TRUE(pinned) << "Expecting a started thread to run a function\n";
+    if (current)
+    {
+        ASSERT_EQ(cpu, *current) << "Expecting a thread to run on the processor it's pinned to\n";
+    }
+}
+
+TEST(ThreadPlacementTests, PlacedPoolAndQueue)
+{
+    const ThreadPlacement placement{ PlacementMode::Scatter };
+    ShardedQueue<int> queue{ placement };
+    ThreadPool pool{ 2u, placement };
+    std::future<long long> sum{ pool.submit([&pool]() { return sum_in_pool(pool, 0, 1000); }) };
+
+    ASSERT_EQ(placement.topology().node_count(), queue.shard_count()) << "Expecting a shard per node\n";
+    ASSERT_EQ(999 * 1000LL / 2, sum.get()) << "Expecting placed workers to run tasks\n";
+    ASSERT_EQ(transferred_total(1000), transfer_in_parallel(queue, 1000)) << "Expecting a queue sharded by nodes to pass all elements\n";
+}
+
+TEST(RelaxedPriorityQueueTests, SingleHeapIsExact)
+{
+    RelaxedPriorityQueue<int> queue{ 1 };
+    for (const int value : { 5, 1, 4, 2, 3 })
+    {
+        queue.push(value);
+    }
+
+    int first{};
+    ASSERT_EQ(1, queue.heap_count());
+    ASSERT_EQ(5, queue.size()) << "Expecting a queue to count pushed elements\n";
+    ASSERT_TRUE(queue.try_pop(first));
+    ASSERT_EQ(1, first) << "Expecting the smallest element to come first\n";
+    const auto second = queue.try_pop();
+    ASSERT_TRUE(second);
+    ASSERT_EQ(2, *second);
+
+    std::vector<int> rest{};
+    ASSERT_EQ(3, queue.pop_min_n(std::back_inserter(rest), 10)) << "Expecting a bulk pop to take what is there\n";
+    ASSERT_EQ((std::vector<int>{ 3, 4, 5 }), rest) << "Expecting a bulk pop to keep the priority order\n";
+    ASSERT_FALSE(queue.try_pop(first)) << "Expecting an empty queue afterwards\n";
+}
+
+TEST(RelaxedPriorityQueueTests, CustomComparison)
+{
+    RelaxedPriorityQueue<int, std::greater<int>> queue{ 1 };
+    queue.emplace(1);
+    queue.emplace(3);
+    queue.emplace(2);
+
+    std::vector<int> values{};
+    queue.pop_min_n(std::back_inserter(values), 2);
+    ASSERT_EQ((std::vector<int>{ 3, 2 }), values) << "Expecting a comparison to define the priority order\n";
+}
+
+TEST(RelaxedPriorityQueueTests, ManyHeapsLoseNothing)
+{
+    constexpr int kCount{ 1000 };
+
+    RelaxedPriorityQueue<int> queue{ 8 };
+    for (int i{ 0 }; i < kCount; ++i)
+    {
+        queue.push(i);
+    }
+
+    std::vector<int> values{};
+    while (queue.pop_min_n(std::back_inserter(values), 7) != 0)
+    {
+        // Drain
+    }
+    std::sort(values.begin(), values.end());
+
+    std::vector<int> expected(kCount);
+    std::iota(expected.begin(), expected.end(), 0);
+    ASSERT_EQ(expected, values) << "Expecting every element to be popped exactly once\n";
+    ASSERT_TRUE(queue.empty());
+}
+
+TEST(RelaxedPriorityQueueTests, PushAndWaitPop)
+{
+    RelaxedPriorityQueue<int> queue{ 4 };
+    std::vector<int> values{};
+    {
+        ThreadStorage threads{ 2u };
+        threads[0] = std::thread{ [&queue, &values]()
+        {
+            queue.wait_and_pop_min_n(std::back_inserter(values), 4);
+        } };
+        threads[1] = std::thread{ [&queue]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            queue.push(7);
+        } };
+    }
+
+    ASSERT_EQ((std::vector<int>{ 7 }), values) << "Expecting a waiting consumer to receive an element\n";
+}
+
+TEST(RelaxedPriorityQueueTests, ParallelProducersAndConsumers)
+{
+    RelaxedPriorityQueue<int> queue{};
+
+    ASSERT_EQ(transferred_total(5000), transfer_in_parallel(queue, 5000))
+        << "Expecting every pushed element to be popped exactly once\n";
+    ASSERT_TRUE(queue.empty()) << "Expecting a queue to be drained\n";
+}
+
+// A coroutine, which starts right away and nobody waits for
+struct Detached
+{
+    struct promise_type
+    {
+        Detached get_return_object() noexcept { return Detached{}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+// Resuming a coroutine on a thread, which hands an element over
+struct InlineExecutor
+{
+    template <typename F>
+    friend void post(InlineExecutor, F&& f)
+    {
+        f();
+    }
+};
+
+// Resuming a coroutine on a worker of a pool
+struct PoolExecutor
+{
+    template <typename F>
+    friend void post(PoolExecutor executor, F&& f)
+    {
+        executor.pool_->submit(std::forward<F>(f));
+    }
+
+    ThreadPool* pool_;
+};
+
+template <typename Queue, typename Executor>
+Detached consume_async(Queue& queue, Executor executor, std::atomic<long long>& sum, std::atomic<int>& finished)
+{
+    while (const std::optional<int> value{ co_await queue.async_pop(executor) })
+    {
+        sum += *value;
+    }
+    ++finished;
+}
+
+TEST(BluntQueueTests, AsyncPopReady)
+{
+    BluntQueue<int> queue{ 1, 2 };
+    std::atomic<long long> sum{ 0 };
+    std::atomic<int> finished{ 0 };
+    consume_async(queue, InlineExecutor{}, sum, finished);
+
+    ASSERT_EQ(3, sum.load()) << "Expecting a coroutine to take available elements without suspension\n";
+    ASSERT_EQ(0, finished.load()) << "Expecting a coroutine to await further elements\n";
+    ASSERT_TRUE(queue.empty());
+
+    queue.close();
+    ASSERT_EQ(1, finished.load()) << "Expecting a closure to release an awaiting coroutine\n";
+}
+
+TEST(BluntQueueTests, AsyncPopResumesOnPush)
+{
+    BluntQueue<int> queue{};
+    std::atomic<long long> sum{ 0 };
+    std::atomic<int> finished{ 0 };
+    consume_async(queue, InlineExecutor{}, sum, finished);
+    consume_async(queue, InlineExecutor{}, sum, finished);
+
+    queue.push(5);
+    ASSERT_EQ(5, sum.load()) << "Expecting a push to resume an awaiting coroutine\n";
+    ASSERT_TRUE(queue.empty()) << "Expecting an element to be handed to a coroutine\n";
+
+    std::vector<int> batch{ 1, 2, 3 };
+    queue.push_bulk(batch);
+    ASSERT_EQ(11, sum.load()) << "Expecting a batch to be delivered to awaiting coroutines\n";
+
+    queue.close();
+    ASSERT_EQ(2, finished.load()) << "Expecting a closure to release all awaiting coroutines\n";
+}
+
+TEST(BluntQueueTests, AsyncPopOnPool)
+{
+    constexpr int kConsumers{ 1000 };
+    constexpr int kCount{ 10000 };
+
+    std::atomic<long long> sum{ 0 };
+    std::atomic<int> finished{ 0 };
+    BluntQueue<int> queue{};
+    {
+        ThreadPool pool{ 2u };
+        for (int c{ 0 }; c < kConsumers; ++c)
+        {
+            consume_async(queue, PoolExecutor{ &pool }, sum, finished);
+        }
+        {
+            ThreadStorage threads{ 2u };
+            for (unsigned t{ 0 }; t < 2u; ++t)
+            {
+                threads[t] = std::thread{ [&queue]()
+                {
+                    for (int i{ 1 }; i <= kCount; ++i)
+                    {
+                        queue.push(i);
+                    }
+                } };
+            }
+        }
+        queue.close();
+
+        while (finished.load() != kConsumers)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    ASSERT_EQ(kCount * (kCount + 1LL), sum.load()) << "Expecting coroutines sharing a pool to receive every element\n";
+}
@@ -0,0 +1,319 @@
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "ThreadPlacement.h"
+
+#if defined(_WIN32)
+
+// Windows numbers processors within groups of up to 64 ones
+static constexpr unsigned kGroupSize{ 64 };
+
+static std::vector<NumaNode> detect_nodes()
+{
+    std::vector<NumaNode> nodes{};
+    ULONG highest{ 0 };
+    if (!GetNumaHighestNodeNumber(&highest))
+    {
+        return nodes;
+    }
+
+    for (USHORT node{ 0 }; node <= highest; ++node)
+    {
+        GROUP_AFFINITY affinity{};
+        if (!GetNumaNodeProcessorMaskEx(node, &affinity))
+        {
+            continue;
+        }
+
+        NumaNode numa{ node, {} };
+        for (unsigned bit{ 0 }; bit < kGroupSize; ++bit)
+        {
+            if (affinity.Mask & (KAFFINITY{ 1 } << bit))
+            {
+                numa.cpus_.push_back(affinity.Group * kGroupSize + bit);
+            }
+        }
+        nodes.push_back(std::move(numa));
+    }
+    return nodes;
+}
+
+#elif defined(__linux__)
+
+// Parsing a sysfs list like "0-3,8,10-11"
+static std::vector<unsigned> parse_list(const std::string& list)
+{
+    std::vector<unsigned> values{};
+    std::istringstream stream{ list };
+    std::string range{};
+    while (std::getline(stream, range, ','))
+    {
+        if (range.empty() || range == "\n")
+        {
+            continue;
+        }
+
+        const std::size_t dash{ range.find('-') };
+        const unsigned first{ static_cast<unsigned>(std::stoul(range.substr(0, dash))) };
+        const unsigned last{ dash == std::string::npos ? first : static_cast<unsigned>(std::stoul(range.substr(dash + 1))) };
+        for (unsigned value{ first }; value <= last; ++value)
+        {
+            values.push_back(value);
+        }
+    }
+    return values;
+}
+
+static std::string read_line(const std::string& path)
+{
+    std::ifstream file{ path };
+    std::string line{};
+    std::getline(file, line);
+    return line;
+}
+
+static std::vector<NumaNode> detect_nodes()
+{
+    std::vector<NumaNode> nodes{};
+    cpu_set_t allowed{};
+    const bool restricted{ sched_getaffinity(0, sizeof(allowed), &allowed) == 0 };
+
+    try
+    {
+        for (const unsigned node : parse_list(read_line("/sys/devices/system/node/online")))
+        {
+            NumaNode numa{ node, {} };
+            const std::string path{ "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist" };
+            for (const unsigned cpu : parse_list(read_line(path)))
+            {
+                // Skip processors excluded by a cgroup or a launcher
+                if (!restricted || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)))
+                {
+                    numa.cpus_.push_back(cpu);
+                }
+            }
+            nodes.push_back(std::move(numa));
+        }
+    }
+    catch (const std::exception&)
+    {
+        // A malformed list is as good as a missing one
+        nodes.clear();
+    }
+
+    if (nodes.empty() && restricted)
+    {
+        NumaNode numa{ 0, {} };
+        for (unsigned cpu{ 0 }; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &allowed))
+            {
+                numa.cpus_.push_back(cpu);
+            }
+        }
+        nodes.push_back(std::move(numa));
+    }
+    return nodes;
+}
+
+#else
+
+static std::vector<NumaNode> detect_nodes()
+{
+    return {};
+}
+
+#endif
+
+CpuTopology CpuTopology::detect()
+{
+    std::vector<NumaNode> nodes{ detect_nodes() };
+    if (nodes.empty())
+    {
+        NumaNode numa{ 0, {} };
+        for (unsigned cpu{ 0 }; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu)
+        {
+            numa.cpus_.push_back(cpu);
+        }
+        nodes.push_back(std::move(numa));
+    }
+    return CpuTopology{ std::move(nodes) };
+}
+
+CpuTopology::CpuTopology(std::vector<NumaNode> nodes) :
+    nodes_{ std::move(nodes) }
+{
+    nodes_.erase(std::remove_if(nodes_.begin(), nodes_.end(),
+        [](const NumaNode& node) { return node.cpus_.empty(); }), nodes_.end());
+    if (nodes_.empty())
+    {
+        nodes_.push_back(NumaNode{ 0, { 0 } });
+    }
+}
+
+const std::vector<NumaNode>& CpuTopology::nodes() const noexcept
+{
+    return nodes_;
+}
+
+std::size_t CpuTopology::node_count() const noexcept
+{
+    return nodes_.size();
+}
+
+std::size_t CpuTopology::cpu_count() const noexcept
+{
+    std::size_t count{ 0 };
+    for (const NumaNode& node : nodes_)
+    {
+        count += node.cpus_.size();
+    }
+    return count;
+}
+
+std::size_t CpuTopology::node_of(const unsigned cpu) const noexcept
+{
+    for (std::size_t n{ 0 }; n < nodes_.size(); ++n)
+    {
+        const std::vector<unsigned>& cpus{ nodes_[n].cpus_ };
+        if (std::find(cpus.cbegin(), cpus.cend(), cpu) != cpus.cend())
+        {
+            return n;
+        }
+    }
+    return 0;
+}
+
+ThreadPlacement::ThreadPlacement() :
+    mode_{ PlacementMode::Floating },
+    topology_{ std::vector<NumaNode>{} }
+{
+    // Empty
+}
+
+ThreadPlacement::ThreadPlacement(const PlacementMode mode) :
+    ThreadPlacement{ mode, CpuTopology::detect() }
+{
+    // Empty
+}
+
+ThreadPlacement::ThreadPlacement(const PlacementMode mode, CpuTopology topology) :
+    mode_{ mode },
+    topology_{ std::move(topology) }
+{
+    // Empty
+}
+
+PlacementMode ThreadPlacement::mode() const noexcept
+{
+    return mode_;
+}
+
+const CpuTopology& ThreadPlacement::topology() const noexcept
+{
+    return topology_;
+}
+
+std::optional<unsigned> ThreadPlacement::cpu_for(const unsigned index) const
+{
+    const std::vector<NumaNode>& nodes{ topology_.nodes() };
+    switch (mode_)
+    {
+    case PlacementMode::Compact:
+    {
+        std::size_t slot{ index % topology_.cpu_count() };
+        for (const NumaNode& node : nodes)
+        {
+            if (slot < node.cpus_.size())
+            {
+                return node.cpus_[slot];
+            }
+            slot -= node.cpus_.size();
+        }
+        return std::nullopt;
+    }
+    case PlacementMode::Scatter:
+    {
+        const NumaNode& node{ nodes[node_for(index)] };
+        return node.cpus_[(index / nodes.size()) % node.cpus_.size()];
+    }
+    default:
+        return std::nullopt;
+    }
+}
+
+std::size_t ThreadPlacement::node_for(const unsigned index) const noexcept
+{
+    if (mode_ == PlacementMode::Compact)
+    {
+        std::size_t slot{ index % topology_.cpu_count() };
+        for (std::size_t n{ 0 }; n < topology_.node_count(); ++n)
+        {
+            const std::size_t size{ topology_.nodes()[n].cpus_.size() };
+            if (slot < size)
+            {
+                return n;
+            }
+            slot -= size;
+        }
+    }
+    return index % topology_.node_count();
+}
+
+bool ThreadPlacement::apply(const unsigned index) const
+{
+    const std::optional<unsigned> cpu{ cpu_for(index) };
+    return cpu && pin_current_thread(*cpu);
+}
+
+bool ThreadPlacement::pin_current_thread(const unsigned cpu)
+{
+#if defined(_WIN32)
+    GROUP_AFFINITY affinity{};
+    affinity.Group = static_cast<WORD>(cpu / kGroupSize);
+    affinity.Mask = KAFFINITY{ 1 } << (cpu % kGroupSize);
+    return SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr) != 0;
+#elif defined(__linux__)
+    if (cpu >= CPU_SETSIZE)
+    {
+        return false;
+    }
+
+    cpu_set_t set{};
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    static_cast<void>(cpu);
+    return false;
+#endif
+}
+
+std::optional<unsigned> ThreadPlacement::current_cpu()
+{
+#if defined(_WIN32)
+    PROCESSOR_NUMBER number{};
+    GetCurrentProcessorNumberEx(&number);
+    return number.Group * kGroupSize + number.Number;
+#elif defined(__linux__)
+    const int cpu{ sched_getcpu() };
+    return cpu < 0 ? std::nullopt : std::optional<unsigned>{ static_cast<unsigned>(cpu) };
+#else
+    return std::nullopt;
+#endif
+}
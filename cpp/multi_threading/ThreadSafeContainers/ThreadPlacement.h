@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+// Processors the process is allowed to run on, grouped by NUMA nodes
+struct NumaNode
+{
+    unsigned id_;
+    std::vector<unsigned> cpus_;
+};
+
+class CpuTopology
+{
+public:
+
+    // Asking the operating system, or falling back to a single node of all hardware threads
+    static CpuTopology detect();
+
+    // Nodes without processors are dropped, and an empty topology turns into a single node of CPU 0
+    explicit CpuTopology(std::vector<NumaNode> nodes);
+
+    const std::vector<NumaNode>& nodes() const noexcept;
+    std::size_t node_count() const noexcept;
+    std::size_t cpu_count() const noexcept;
+
+    // A position of a node within nodes(), which is 0 for unknown processors
+    std::size_t node_of(unsigned cpu) const noexcept;
+
+private:
+
+    std::vector<NumaNode> nodes_;
+
+};
+
+// Floating threads are up to the scheduler, the other modes pin a thread per processor:
+// compact ones fill a node up before moving to the next one, keeping communicating threads close,
+// whereas scattered ones alternate nodes, spreading the memory bandwidth demand evenly
+enum class PlacementMode
+{
+    Floating,
+    Compact,
+    Scatter
+};
+
+// Assigning the i-th thread of a group to a processor and a NUMA node.
+// Both wrap around, once there are more threads than processors.
+//
+// A pinned thread is to be placed before it allocates anything, so that the memory it touches first
+// is mapped on its local node. Placement is advisory: failing to pin a thread leaves it floating
+class ThreadPlacement
+{
+public:
+
+    ThreadPlacement();
+    explicit ThreadPlacement(PlacementMode mode);
+    ThreadPlacement(PlacementMode mode, CpuTopology topology);
+
+    PlacementMode mode() const noexcept;
+    const CpuTopology& topology() const noexcept;
+
+    // No processor is assigned to floating threads, which are spread across nodes nevertheless
+    std::optional<unsigned> cpu_for(unsigned index) const;
+    std::size_t node_for(unsigned index) const noexcept;
+
+    // Pinning the calling thread as the i-th one of the group
+    bool apply(unsigned index) const;
+
+    static bool pin_current_thread(unsigned cpu);
+    static std::optional<unsigned> current_cpu();
+
+private:
+
+    PlacementMode mode_;
+    CpuTopology topology_;
+
+};
@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "ThreadPool.h"
+
+// A worker knows its pool and its deque, so that tasks it runs submit subtasks locally
+static thread_local ThreadPool* currentPool{ nullptr };
+static thread_local unsigned currentWorker{ 0 };
+
+ThreadPool::ThreadPool(const unsigned workers) :
+    ThreadPool{ workers, ThreadPlacement{} }
+{
+    // Empty
+}
+
+ThreadPool::ThreadPool(const unsigned workers, ThreadPlacement placement) :
+    size_{ std::max(1u, workers) },
+    tasks_{},
+    deques_{ std::make_unique<WorkStealingDeque<Task*>[]>(size_) },
+    victims_(size_),
+    queued_{ 0 },
+    pending_{ 0 },
+    stopping_{ false },
+    idle_{},
+    workers_{ size_, std::move(placement) }
+{
+    const ThreadPlacement& placed{ workers_.placement() };
+    for (unsigned w{ 0 }; w < size_; ++w)
+    {
+        // The neighbours on the same node round-robin starting with the next one, and the remote workers then
+        std::vector<unsigned>& victims{ victims_[w] };
+        for (unsigned v{ 1 }; v < size_; ++v)
+        {
+            victims.push_back((w + v) % size_);
+        }
+        std::stable_partition(victims.begin(), victims.end(), [&placed, w](const unsigned v)
+        {
+            return placed.node_for(v) == placed.node_for(w);
+        });
+    }
+
+    for (unsigned w{ 0 }; w < size_; ++w)
+    {
+        workers_.start(w, [this, w]() { work(w); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    shutdown();
+}
+
+bool ThreadPool::run_pending_task()
+{
+    Task task{};
+    if (!take(task))
+    {
+        return false;
+    }
+
+    // A submitted task hands an exception to its future, so nothing escapes to the caller
+    task();
+    task = Task{};
+    complete();
+    return true;
+}
+
+void ThreadPool::shutdown()
+{
+    tasks_.close();
+    stopping_.store(true);
+    idle_.notify_all();
+    workers_.join();
+}
+
+unsigned ThreadPool::size() const noexcept
+{
+    return size_;
+}
+
+unsigned ThreadPool::default_size() noexcept
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void ThreadPool::schedule(Task task)
+{
+    // Count a task before it's published, so that workers never leave it behind on shutdown
+    pending_.fetch_add(1);
+    if (currentPool == this)
+    {
+        std::unique_ptr<Task> local{ std::make_unique<Task>(std::move(task)) };
+        try
+        {
+            deques_[currentWorker].push(local.get());
+        }
+        catch (...)
+        {
+            complete();
+            throw;
+        }
+        local.release();
+    }
+    else if (!tasks_.wait_and_push(std::move(task)))
+    {
+        complete();
+        throw std::runtime_error{ "Submitting a task to a thread pool, which has been shut down" };
+    }
+
+    queued_.fetch_add(1);
+    idle_.notify_one();
+}
+
+bool ThreadPool::take(Task& task)
+{
+    const bool worker{ currentPool == this };
+    if (worker)
+    {
+        if (const std::optional<Task*> local{ deques_[currentWorker].pop() })
+        {
+            queued_.fetch_sub(1);
+            task = std::move(**local);
+            delete *local;
+            return true;
+        }
+    }
+
+    if (tasks_.try_pop(task))
+    {
+        queued_.fetch_sub(1);
+        return true;
+    }
+
+    // An outsider helping out has got no neighbours, so it starts with the first worker
+    const unsigned count{ worker ? size_ - 1 : size_ };
+    for (unsigned v{ 0 }; v < count; ++v)
+    {
+        const unsigned victim{ worker ? victims_[currentWorker][v] : v };
+        if (const std::optional<Task*> stolen{ deques_[victim].steal() })
+        {
+            queued_.fetch_sub(1);
+            task = std::move(**stolen);
+            delete *stolen;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::complete() noexcept
+{
+    // The last task of a pool being shut down lets idle workers go
+    if (pending_.fetch_sub(1) == 1 && stopping_.load())
+    {
+        idle_.notify_all();
+    }
+}
+
+void ThreadPool::work(const unsigned index)
+{
+    currentPool = this;
+    currentWorker = index;
+
+    while (true)
+    {
+        if (run_pending_task())
+        {
+            continue;
+        }
+
+        if (stopping_.load() && pending_.load() == 0)
+        {
+            break;
+        }
+
+        NoLock lock{};
+        idle_.wait(lock, [this]()
+        {
+            return queued_.load() > 0 || (stopping_.load() && pending_.load() == 0);
+        });
+    }
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "BluntQueue.hpp"
+#include "CacheLine.hpp"
+#include "ThreadPlacement.h"
+#include "ThreadStorage.h"
+#include "WaitPolicies.hpp"
+#include "WorkStealingDeque.hpp"
+
+// A unit of work of ThreadPool. Unlike std::function it is move-only,
+// so that it can own a promise and any other move-only state
+class Task
+{
+public:
+
+    Task() = default;
+
+    template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+    explicit Task(F&& f);
+
+    Task(const Task& other) = delete;
+    Task(Task&& other) noexcept = default;
+    Task& operator=(const Task& other) = delete;
+    Task& operator=(Task&& other) noexcept = default;
+
+    ~Task() noexcept = default;
+
+    void operator()();
+
+    explicit operator bool() const noexcept;
+
+private:
+
+    struct Callable
+    {
+        virtual ~Callable() = default;
+        virtual void call() = 0;
+    };
+
+    template <typename F>
+    struct Holder final : Callable
+    {
+        explicit Holder(F&& f) : f_{ std::move(f) } {}
+        void call() override { std::invoke(f_); }
+
+        F f_;
+    };
+
+    std::unique_ptr<Callable> callable_;
+
+};
+
+template <typename F, typename>
+Task::Task(F&& f) :
+    callable_{ std::make_unique<Holder<std::decay_t<F>>>(std::decay_t<F>{ std::forward<F>(f) }) }
+{
+    // Empty
+}
+
+inline void Task::operator()()
+{
+    callable_->call();
+}
+
+inline Task::operator bool() const noexcept
+{
+    return static_cast<bool>(callable_);
+}
+
+// A fixed number of long-lived workers, so that short tasks don't pay for creating and joining threads.
+// Tasks submitted by outsiders go to a shared queue, whereas tasks submitted by a task go to
+// the work-stealing deque of the worker running it. A worker runs its own tasks in LIFO order,
+// and looks at the shared queue and steals from the other workers in FIFO order once it's out of its own,
+// so recursive and fork-join workloads don't serialize on a single lock.
+//
+// A result or an exception of a task is delivered through the future returned on submission.
+// A task waiting for its subtasks is to help running them by run_pending_task(),
+// rather than to block a worker, which might be the only one able to run them.
+// A shutdown stops accepting outsider tasks, lets workers complete all tasks including
+// the ones spawned meanwhile and joins them. The pool is shut down on destruction,
+// unless it has been done explicitly by its owner, which is never to be done from a task,
+// since a worker would wait for itself
+class ThreadPool
+{
+public:
+
+    ThreadPool() = delete;
+    ThreadPool(const ThreadPool& other) = delete;
+    ThreadPool(ThreadPool&& other) = delete;
+    ThreadPool& operator=(const ThreadPool& other) = delete;
+    ThreadPool& operator=(ThreadPool&& other) = delete;
+
+    explicit ThreadPool(const unsigned workers);
+    // Placed workers steal from their NUMA node neighbours first and keep their deques on the local node
+    ThreadPool(const unsigned workers, ThreadPlacement placement);
+    ~ThreadPool();
+
+    // Submitting a task from outside to a pool, which has been shut down, throws std::runtime_error
+    template <typename F>
+    std::future<std::invoke_result_t<std::decay_t<F>>> submit(F&& f);
+
+    // Running a single pending task on the calling thread, if there is any
+    bool run_pending_task();
+
+    void shutdown();
+
+    unsigned size() const noexcept;
+
+    // A worker per hardware thread
+    static unsigned default_size() noexcept;
+
+private:
+
+    void schedule(Task task);
+    bool take(Task& task);
+    void complete() noexcept;
+    void work(unsigned index);
+
+    const unsigned size_;
+    BluntQueue<Task> tasks_;
+    std::unique_ptr<WorkStealingDeque<Task*>[]> deques_;
+    // Every worker looks at victims in its own order, since the closest ones come first
+    std::vector<std::vector<unsigned>> victims_;
+
+    // Tasks published and not taken yet, which idle workers wait for
+    alignas(kCacheLineSize) std::atomic<long long> queued_;
+    // Tasks submitted and not completed yet, which a shutdown waits for
+    alignas(kCacheLineSize) std::atomic<long long> pending_;
+    std::atomic<bool> stopping_;
+    BlockWait idle_;
+
+    ThreadStorage workers_;
+
+};
+
+template <typename F>
+std::future<std::invoke_result_t<std::decay_t<F>>> ThreadPool::submit(F&& f)
+{
+    using Result = std::invoke_result_t<std::decay_t<F>>;
+
+    // Not a std::packaged_task, since some implementations of it demand copyable callables
+    std::promise<Result> promise{};
+    std::future<Result> result{ promise.get_future() };
+    Task task{ [promise = std::move(promise), f = std::decay_t<F>{ std::forward<F>(f) }]() mutable
+    {
+        try
+        {
+            if constexpr (std::is_void_v<Result>)
+            {
+                std::invoke(f);
+                promise.set_value();
+            }
+            else
+            {
+                promise.set_value(std::invoke(f));
+            }
+        }
+        catch (...)
+        {
+            promise.set_exception(std::current_exception());
+        }
+    } };
+
+    schedule(std::move(task));
+    return result;
+}
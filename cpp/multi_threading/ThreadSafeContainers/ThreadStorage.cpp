@@ -1,12 +1,32 @@
+#include <utility>
+
 #include "ThreadStorage.h"
 
 ThreadStorage::ThreadStorage(const unsigned number) :
-    ThreadStorage::Base(number)
+    ThreadStorage::Base(number),
+    placement_{}
+{
+    // Empty
+}
+
+ThreadStorage::ThreadStorage(const unsigned number, ThreadPlacement placement) :
+    ThreadStorage::Base(number),
+    placement_{ std::move(placement) }
 {
     // Empty
 }
 
 ThreadStorage::~ThreadStorage()
+{
+    join();
+}
+
+const ThreadPlacement& ThreadStorage::placement() const noexcept
+{
+    return placement_;
+}
+
+void ThreadStorage::join()
 {
     for (Base::iterator t{ begin() }; t != end(); ++t)
     {
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <functional>
 #include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "ThreadPlacement.h"
+
 class ThreadStorage : private std::vector<std::thread>
 {
 private:
@@ -18,8 +23,32 @@ public:
     ThreadStorage& operator=(ThreadStorage&& other) = delete;
 
     explicit ThreadStorage(const unsigned number);
+    ThreadStorage(const unsigned number, ThreadPlacement placement);
     ~ThreadStorage();
 
     using Base::operator[];
 
-};
\ No newline at end of file
+    // Starting the i-th thread, which places itself according to the placement before running a function
+    template <typename F>
+    void start(const unsigned index, F&& f);
+
+    const ThreadPlacement& placement() const noexcept;
+
+    // Waiting for all running threads to complete, which the destructor does anyway
+    void join();
+
+private:
+
+    const ThreadPlacement placement_;
+
+};
+
+template <typename F>
+void ThreadStorage::start(const unsigned index, F&& f)
+{
+    (*this)[index] = std::thread{ [this, index, f = std::decay_t<F>{ std::forward<F>(f) }]() mutable
+    {
+        placement_.apply(index);
+        std::invoke(f);
+    } };
+}
@@ -0,0 +1,301 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "CacheLine.hpp"
+
+// Strategies, by which the queues make threads wait for a condition: elements to pop or a room to push.
+// Each of them provides the interface of std::condition_variable the queues rely on:
+//
+//     template <typename Lock, typename Predicate>
+//     void wait(Lock& lock, Predicate ready);
+//     void notify_one();
+//     void notify_all();
+//
+// A waiter registers itself before checking the condition under the caller's lock for the last time,
+// and then parks until a notification counter moves on. A notifier changes the condition first
+// and skips any work, as long as nobody is registered, so the uncontended path issues no syscalls
+
+// A lock stand-in for containers, which check their conditions with atomic operations only
+struct NoLock
+{
+    void lock() noexcept {}
+    void unlock() noexcept {}
+};
+
+// Hint a processor that a thread is spinning
+inline void cpu_relax() noexcept
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+// Bookkeeping shared by the strategies: the number of registered waiters and the notification counter
+class WaitState
+{
+protected:
+
+    WaitState() = default;
+    WaitState(const WaitState& other) = delete;
+    WaitState& operator=(const WaitState& other) = delete;
+    ~WaitState() = default;
+
+    // Parks by means of a callable, which returns once the counter differs from the given value
+    template <typename Lock, typename Predicate, typename Park>
+    void wait(Lock& lock, Predicate ready, Park park);
+
+    // Moves the counter on, unless nobody waits, and tells whether waiters are to be woken up
+    bool signal() noexcept;
+
+    alignas(kCacheLineSize) std::atomic<std::uint32_t> epoch_{ 0 };
+    std::atomic<int> waiters_{ 0 };
+
+};
+
+template <typename Lock, typename Predicate, typename Park>
+void WaitState::wait(Lock& lock, Predicate ready, Park park)
+{
+    if (ready())
+    {
+        return;
+    }
+
+    waiters_.fetch_add(1);
+    while (true)
+    {
+        const std::uint32_t seen{ epoch_.load() };
+        if (ready())
+        {
+            break;
+        }
+
+        lock.unlock();
+        park(seen);
+        lock.lock();
+    }
+    waiters_.fetch_sub(1);
+}
+
+inline bool WaitState::signal() noexcept
+{
+    if (waiters_.load() == 0)
+    {
+        return false;
+    }
+
+    epoch_.fetch_add(1);
+    return true;
+}
+
+// Sleeping on a condition variable right away, which suits long idle periods best
+class BlockWait : private WaitState
+{
+public:
+
+    template <typename Lock, typename Predicate>
+    void wait(Lock& lock, Predicate ready);
+
+    void notify_one();
+    void notify_all();
+
+private:
+
+    std::mutex mutex_;
+    std::condition_variable isSignaled_;
+
+};
+
+template <typename Lock, typename Predicate>
+void BlockWait::wait(Lock& lock, Predicate ready)
+{
+    WaitState::wait(lock, ready, [this](const std::uint32_t seen)
+    {
+        std::unique_lock<std::mutex> sleep{ mutex_ };
+        isSignaled_.wait(sleep, [this, seen]() { return epoch_.load() != seen; });
+    });
+}
+
+inline void BlockWait::notify_one()
+{
+    if (signal())
+    {
+        // Pass through the mutex to make sure a waiter is either asleep or yet to look at the counter
+        {
+            std::lock_guard<std::mutex> lock{ mutex_ };
+        }
+        isSignaled_.notify_one();
+    }
+}
+
+inline void BlockWait::notify_all()
+{
+    if (signal())
+    {
+        {
+            std::lock_guard<std::mutex> lock{ mutex_ };
+        }
+        isSignaled_.notify_all();
+    }
+}
+
+// Busy spinning, which burns a core per waiter, but reacts within nanoseconds
+class SpinWait : private WaitState
+{
+public:
+
+    template <typename Lock, typename Predicate>
+    void wait(Lock& lock, Predicate ready);
+
+    void notify_one() noexcept;
+    void notify_all() noexcept;
+
+};
+
+template <typename Lock, typename Predicate>
+void SpinWait::wait(Lock& lock, Predicate ready)
+{
+    WaitState::wait(lock, ready, [this](const std::uint32_t seen)
+    {
+        while (epoch_.load(std::memory_order_relaxed) == seen)
+        {
+            cpu_relax();
+        }
+    });
+}
+
+inline void SpinWait::notify_one() noexcept
+{
+    signal();
+}
+
+inline void SpinWait::notify_all() noexcept
+{
+    signal();
+}
+
+// Spinning for a bounded number of iterations to catch bursts, before falling asleep on a condition variable
+template <std::size_t Spins = 4096>
+class SpinBlockWait : private WaitState
+{
+public:
+
+    template <typename Lock, typename Predicate>
+    void wait(Lock& lock, Predicate ready);
+
+    void notify_one();
+    void notify_all();
+
+private:
+
+    template <typename Notify>
+    void wake(Notify notify);
+
+    // Notifiers need the mutex only for waiters, which are asleep already
+    std::atomic<int> sleepers_{ 0 };
+    std::mutex mutex_;
+    std::condition_variable isSignaled_;
+
+};
+
+template <std::size_t Spins>
+template <typename Lock, typename Predicate>
+void SpinBlockWait<Spins>::wait(Lock& lock, Predicate ready)
+{
+    WaitState::wait(lock, ready, [this](const std::uint32_t seen)
+    {
+        for (std::size_t s{ 0 }; s < Spins; ++s)
+        {
+            if (epoch_.load(std::memory_order_relaxed) != seen)
+            {
+                return;
+            }
+            cpu_relax();
+        }
+
+        std::unique_lock<std::mutex> sleep{ mutex_ };
+        sleepers_.fetch_add(1);
+        isSignaled_.wait(sleep, [this, seen]() { return epoch_.load() != seen; });
+        sleepers_.fetch_sub(1);
+    });
+}
+
+template <std::size_t Spins>
+void SpinBlockWait<Spins>::notify_one()
+{
+    wake([this]() { isSignaled_.notify_one(); });
+}
+
+template <std::size_t Spins>
+void SpinBlockWait<Spins>::notify_all()
+{
+    wake([this]() { isSignaled_.notify_all(); });
+}
+
+template <std::size_t Spins>
+template <typename Notify>
+void SpinBlockWait<Spins>::wake(Notify notify)
+{
+    // Spinning waiters notice the counter on their own
+    if (signal() && sleepers_.load() > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock{ mutex_ };
+        }
+        notify();
+    }
+}
+
+// Parking on the notification counter itself by means of std::atomic::wait,
+// which lets the standard library pick the cheapest primitive of a platform, e.g. a futex
+class AtomicWait : private WaitState
+{
+public:
+
+    template <typename Lock, typename Predicate>
+    void wait(Lock& lock, Predicate ready);
+
+    void notify_one() noexcept;
+    void notify_all() noexcept;
+
+};
+
+template <typename Lock, typename Predicate>
+void AtomicWait::wait(Lock& lock, Predicate ready)
+{
+    WaitState::wait(lock, ready, [this](const std::uint32_t seen)
+    {
+        epoch_.wait(seen);
+    });
+}
+
+inline void AtomicWait::notify_one() noexcept
+{
+    if (signal())
+    {
+        epoch_.notify_one();
+    }
+}
+
+inline void AtomicWait::notify_all() noexcept
+{
+    if (signal())
+    {
+        epoch_.notify_all();
+    }
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "CacheLine.hpp"
+
+// A Chase-Lev deque: an owner thread pushes and pops at the bottom end in LIFO order,
+// whereas any other thread steals from the top end in FIFO order.
+// The owner keeps touching the recently pushed and still hot elements, and thieves take the oldest,
+// which are usually the largest pieces of a divide-and-conquer job.
+//
+// Elements are copied in and out of atomic slots, so they are to be trivially copyable, e.g. pointers.
+// A circular buffer is allocated by the first push, i.e. by the owner and on its memory node,
+// it grows on demand, and outgrown buffers are kept until the deque is gone,
+// since a thief might still be reading them
+template <typename T>
+class WorkStealingDeque
+{
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "Expecting elements to be trivially copyable");
+
+    using size_type = std::size_t;
+
+    explicit WorkStealingDeque(size_type capacity = 64);
+
+    WorkStealingDeque(const WorkStealingDeque& other) = delete;
+    WorkStealingDeque(WorkStealingDeque&& other) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque& other) = delete;
+    WorkStealingDeque& operator=(WorkStealingDeque&& other) = delete;
+
+    ~WorkStealingDeque() noexcept = default;
+
+    // Owner operations
+    void push(T value);
+    std::optional<T> pop();
+
+    // Stealing gives up both when the deque is empty and when another party wins the race for an element
+    std::optional<T> steal();
+
+    // The size is exact only in absence of concurrent modifications
+    size_type size() const noexcept;
+    bool empty() const noexcept;
+
+private:
+
+    class Ring
+    {
+    public:
+
+        explicit Ring(size_type capacity);
+
+        size_type capacity() const noexcept;
+
+        void put(std::int64_t index, T value) noexcept;
+        T get(std::int64_t index) const noexcept;
+
+    private:
+
+        const size_type mask_;
+        std::unique_ptr<std::atomic<T>[]> slots_;
+
+    };
+
+    Ring* grow(Ring* ring, std::int64_t bottom, std::int64_t top);
+
+    const size_type capacity_;
+    alignas(kCacheLineSize) std::atomic<std::int64_t> top_;
+    alignas(kCacheLineSize) std::atomic<std::int64_t> bottom_;
+    std::atomic<Ring*> ring_;
+    // Every buffer ever used, which is touched by the owner only
+    std::vector<std::unique_ptr<Ring>> rings_;
+
+};
+
+template <typename T>
+WorkStealingDeque<T>::Ring::Ring(size_type capacity) :
+    mask_{ capacity - 1 },
+    slots_{ std::make_unique<std::atomic<T>[]>(capacity) }
+{
+    // Empty
+}
+
+template <typename T>
+typename WorkStealingDeque<T>::size_type WorkStealingDeque<T>::Ring::capacity() const noexcept
+{
+    return mask_ + 1;
+}
+
+template <typename T>
+void WorkStealingDeque<T>::Ring::put(std::int64_t index, T value) noexcept
+{
+    slots_[static_cast<size_type>(index) & mask_].store(value, std::memory_order_relaxed);
+}
+
+template <typename T>
+T WorkStealingDeque<T>::Ring::get(std::int64_t index) const noexcept
+{
+    return slots_[static_cast<size_type>(index) & mask_].load(std::memory_order_relaxed);
+}
+
+template <typename T>
+WorkStealingDeque<T>::WorkStealingDeque(size_type capacity) :
+    capacity_{ std::bit_ceil(std::max<size_type>(capacity, 1)) },
+    top_{ 0 },
+    bottom_{ 0 },
+    ring_{ nullptr },
+    rings_{}
+{
+    // Empty
+}
+
+template <typename T>
+void WorkStealingDeque<T>::push(T value)
+{
+    const std::int64_t bottom{ bottom_.load(std::memory_order_relaxed) };
+    const std::int64_t top{ top_.load(std::memory_order_acquire) };
+    Ring* ring{ ring_.load(std::memory_order_relaxed) };
+    if (ring == nullptr || bottom - top >= static_cast<std::int64_t>(ring->capacity()))
+    {
+        ring = grow(ring, bottom, top);
+    }
+
+    ring->put(bottom, value);
+    // Publish the element along with everything it refers to
+    bottom_.store(bottom + 1, std::memory_order_release);
+}
+
+template <typename T>
+std::optional<T> WorkStealingDeque<T>::pop()
+{
+    const std::int64_t bottom{ bottom_.load(std::memory_order_relaxed) - 1 };
+    Ring* ring{ ring_.load(std::memory_order_relaxed) };
+    // Reserve the bottom element before looking at thieves
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t top{ top_.load(std::memory_order_relaxed) };
+
+    if (top > bottom)
+    {
+        // Empty
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    std::optional<T> value{ ring->get(bottom) };
+    if (top == bottom)
+    {
+        // The last element is contended by thieves, so it goes to the winner of the race for the top
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            value.reset();
+        }
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return value;
+}
+
+template <typename T>
+std::optional<T> WorkStealingDeque<T>::steal()
+{
+    std::int64_t top{ top_.load(std::memory_order_acquire) };
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const std::int64_t bottom{ bottom_.load(std::memory_order_acquire) };
+
+    if (top >= bottom)
+    {
+        return std::nullopt;
+    }
+
+    const T value{ ring_.load(std::memory_order_acquire)->get(top) };
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+        return std::nullopt;
+    }
+    return value;
+}
+
+template <typename T>
+typename WorkStealingDeque<T>::size_type WorkStealingDeque<T>::size() const noexcept
+{
+    const std::int64_t bottom{ bottom_.load(std::memory_order_relaxed) };
+    const std::int64_t top{ top_.load(std::memory_order_relaxed) };
+    return bottom > top ? static_cast<size_type>(bottom - top) : 0;
+}
+
+template <typename T>
+bool WorkStealingDeque<T>::empty() const noexcept
+{
+    return size() == 0;
+}
+
+template <typename T>
+typename WorkStealingDeque<T>::Ring* WorkStealingDeque<T>::grow(Ring* ring, std::int64_t bottom, std::int64_t top)
+{
+    rings_.push_back(std::make_unique<Ring>(ring == nullptr ? capacity_ : ring->capacity() * 2));
+    Ring* grown{ rings_.back().get() };
+    for (std::int64_t i{ top }; ring != nullptr && i < bottom; ++i)
+    {
+        grown->put(i, ring->get(i));
+    }
+    ring_.store(grown, std::memory_order_release);
+    return grown;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <zmq.hpp>
+
+// Messages of the ventilator, the workers and the sink as little-endian records of fixed size.
+// Timestamps are nanoseconds of the steady clock, which is shared by the processes of a host,
+// so the timings of a batch are only meaningful while all of them run on the same host
+using task_clock = std::chrono::steady_clock;
+
+inline std::int64_t task_clock_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(task_clock::now().time_since_epoch()).count();
+}
+
+// A start of a batch the ventilator sends to the sink, so that the sink waits for as many tasks
+// and measures the batch from the moment it was started
+struct batch_start
+{
+    std::uint64_t tasks_num;
+    std::int64_t started_ns;
+};
+
+// A task the ventilator sends to a worker
+struct task
+{
+    std::int64_t dispatched_ns;
+    std::uint32_t workload_ms;
+};
+
+// A confirmation a worker sends to the sink once it's done with a task. A multi-threaded worker
+// tells how many tasks it runs at once, so that its busy time is accounted per thread
+struct task_confirmation
+{
+    std::uint32_t worker_id;
+    std::uint32_t threads_num;
+    std::int64_t dispatched_ns;
+    std::int64_t started_ns;
+    std::int64_t duration_ns;
+};
+
+constexpr std::size_t kBatchStartSize{ 2 * sizeof(std::uint64_t) };
+constexpr std::size_t kTaskSize{ sizeof(std::uint64_t) + sizeof(std::uint32_t) };
+constexpr std::size_t kTaskConfirmationSize{ 2 * sizeof(std::uint32_t) + 3 * sizeof(std::uint64_t) };
+
+template <typename Integer>
+void store_integer(unsigned char* destination, Integer value)
+{
+    const auto bits{ static_cast<std::uint64_t>(value) };
+    for (std::size_t b{ 0 }; b < sizeof(Integer); ++b)
+    {
+        destination[b] = static_cast<unsigned char>(bits >> (8 * b));
+    }
+}
+
+template <typename Integer>
+Integer load_integer(const unsigned char* source)
+{
+    std::uint64_t bits{ 0 };
+    for (std::size_t b{ 0 }; b < sizeof(Integer); ++b)
+    {
+        bits |= static_cast<std::uint64_t>(source[b]) << (8 * b);
+    }
+    return static_cast<Integer>(bits);
+}
+
+inline zmq::message_t encode(const batch_start& start)
+{
+    zmq::message_t message{ kBatchStartSize };
+    auto* data{ static_cast<unsigned char*>(message.data()) };
+    store_integer(data, start.tasks_num);
+    store_integer(data + sizeof(std::uint64_t), start.started_ns);
+    return message;
+}
+
+// Read a start of a batch telling whether the message is one
+inline bool decode(const zmq::message_t& message, batch_start& start)
+{
+    if (message.size() != kBatchStartSize)
+    {
+        return false;
+    }
+    const auto* data{ static_cast<const unsigned char*>(message.data()) };
+    start.tasks_num = load_integer<std::uint64_t>(data);
+    start.started_ns = load_integer<std::int64_t>(data + sizeof(std::uint64_t));
+    return true;
+}
+
+inline zmq::message_t encode(const task& t)
+{
+    zmq::message_t message{ kTaskSize };
+    auto* data{ static_cast<unsigned char*>(message.data()) };
+    store_integer(data, t.dispatched_ns);
+    store_integer(data + sizeof(std::uint64_t), t.workload_ms);
+    return message;
+}
+
+// Read a task telling whether the message is one
+inline bool decode(const zmq::message_t& message, task& t)
+{
+    if (message.size() != kTaskSize)
+    {
+        return false;
+    }
+    const auto* data{ static_cast<const unsigned char*>(message.data()) };
+    t.dispatched_ns = load_integer<std::int64_t>(data);
+    t.workload_ms = load_integer<std::uint32_t>(data + sizeof(std::uint64_t));
+    return true;
+}
+
+// Lay a number of confirmations back to back within a single message
+inline zmq::message_t encode(const task_confirmation* confirmations, std::size_t count)
+{
+    zmq::message_t message{ count * kTaskConfirmationSize };
+    auto* data{ static_cast<unsigned char*>(message.data()) };
+    for (std::size_t c{ 0 }; c < count; ++c, data += kTaskConfirmationSize)
+    {
+        store_integer(data, confirmations[c].worker_id);
+        store_integer(data + sizeof(std::uint32_t), confirmations[c].threads_num);
+        store_integer(data + 2 * sizeof(std::uint32_t), confirmations[c].dispatched_ns);
+        store_integer(data + 2 * sizeof(std::uint32_t) + sizeof(std::uint64_t), confirmations[c].started_ns);
+        store_integer(data + 2 * sizeof(std::uint32_t) + 2 * sizeof(std::uint64_t), confirmations[c].duration_ns);
+    }
+    return message;
+}
+
+// Visit every confirmation of a message. Tell the number of them, or zero for a malformed message
+template <typename Visitor>
+std::size_t for_each_confirmation(const zmq::message_t& message, Visitor visit)
+{
+    if (message.size() == 0 || message.size() % kTaskConfirmationSize != 0)
+    {
+        return 0;
+    }
+    const auto count{ message.size() / kTaskConfirmationSize };
+    const auto* data{ static_cast<const unsigned char*>(message.data()) };
+    for (std::size_t c{ 0 }; c < count; ++c, data += kTaskConfirmationSize)
+    {
+        task_confirmation confirmation{};
+        confirmation.worker_id = load_integer<std::uint32_t>(data);
+        confirmation.threads_num = load_integer<std::uint32_t>(data + sizeof(std::uint32_t));
+        confirmation.dispatched_ns = load_integer<std::int64_t>(data + 2 * sizeof(std::uint32_t));
+        confirmation.started_ns = load_integer<std::int64_t>(data + 2 * sizeof(std::uint32_t) + sizeof(std::uint64_t));
+        confirmation.duration_ns = load_integer<std::int64_t>(data + 2 * sizeof(std::uint32_t) + 2 * sizeof(std::uint64_t));
+        visit(confirmation);
+    }
+    return count;
+}
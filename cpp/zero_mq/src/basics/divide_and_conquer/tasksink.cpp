@@ -1,8 +1,41 @@
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <map>
+#include <vector>
 
 #include <zmq.hpp>
 
+#include "task_protocol.hpp"
+
+// What a worker has been through during a batch. A multi-threaded worker is busy for as long
+// as its threads are altogether, so it's compared to others by the busy time per thread
+struct worker_stats
+{
+    std::uint64_t tasks_num{ 0 };
+    std::int64_t busy_ns{ 0 };
+    std::uint32_t threads_num{ 1 };
+
+    double thread_busy_ns() const
+    {
+        return static_cast<double>(busy_ns) / threads_num;
+    }
+};
+
+double percentile_ms(std::vector<std::int64_t>& delays, double fraction)
+{
+    if (delays.empty())
+    {
+        return 0.0;
+    }
+    const auto rank{ std::min(delays.size() - 1, static_cast<std::size_t>(fraction * delays.size())) };
+    std::nth_element(delays.begin(), delays.begin() + rank, delays.end());
+    return delays[rank] / 1e6;
+}
+
+// Collect confirmations of a batch, as many as the ventilator has told it to contain,
+// and report how long the batch took and how evenly the workers shared it
 int main()
 {
     zmq::context_t context{};
@@ -12,35 +45,81 @@ int main()
     receiver.bind("tcp://*:5558");
 
     // Wait for a notification that a batch is coming
-    zmq::message_t batch_start_message{};
-    const auto batch_start_status{ receiver.recv(batch_start_message) };
+    batch_start batch{};
+    while (true)
+    {
+        zmq::message_t batch_start_message{};
+        const auto batch_start_status{ receiver.recv(batch_start_message) };
+        if (decode(batch_start_message, batch))
+        {
+            break;
+        }
+        std::cerr << "Failed to decode a start of a batch of " << batch_start_message.size() << " bytes\n";
+    }
+    std::cout << "Waiting for " << batch.tasks_num << " tasks" << std::endl;
 
-    // Start tracking time taken to process all confirmations
-    const auto start_point{ std::chrono::system_clock::now() };
+    std::map<std::uint32_t, worker_stats> workers{};
+    std::vector<std::int64_t> queueing_delays{};
+    queueing_delays.reserve(batch.tasks_num);
 
-    constexpr auto kMaxConfirmations{ 100 };
-    for (auto c{ 0 }; c < kMaxConfirmations; ++c)
+    // Entertain a user with some ASCII art, a dot per percent of the batch
+    const auto progress_step{ std::max<std::uint64_t>(batch.tasks_num / 100, 1) };
+    std::uint64_t confirmed{ 0 };
+    while (confirmed < batch.tasks_num)
     {
-        // Receive a yet another confirmation from a worker
+        // Receive a yet another confirmation from a worker, or a batch of them from a multi-threaded one
         zmq::message_t confirmation_message{};
         const auto confirmation_status{ receiver.recv(confirmation_message) };
-
-        // Entertain a user with some ASCII art
-        if (0 == c % 10)
+        const auto confirmations{ for_each_confirmation(confirmation_message, [&](const task_confirmation& confirmation)
         {
-            std::cout << ":";
-        }
-        else
+            auto& worker{ workers[confirmation.worker_id] };
+            ++worker.tasks_num;
+            worker.busy_ns += confirmation.duration_ns;
+            worker.threads_num = std::max<std::uint32_t>(confirmation.threads_num, 1);
+            queueing_delays.push_back(confirmation.started_ns - confirmation.dispatched_ns);
+
+            ++confirmed;
+            if (0 == confirmed % progress_step)
+            {
+                std::cout << (0 == confirmed % (10 * progress_step) ? ":" : ".") << std::flush;
+            }
+        }) };
+        if (confirmations == 0)
         {
-            std::cout << ".";
+            std::cerr << "Failed to decode a confirmation of " << confirmation_message.size() << " bytes\n";
         }
     }
 
-    // Wrap up tracking of the total elapsed time
-    const auto stop_point{ std::chrono::system_clock::now() };
-    const auto elapsed{ std::chrono::duration_cast<std::chrono::milliseconds>(stop_point - start_point) };
-    std::cout << "\nTotal elapsed time: " << elapsed << "\n";
+    // Wrap up tracking of the total elapsed time since the ventilator started the batch
+    const std::chrono::nanoseconds makespan{ task_clock_ns() - batch.started_ns };
+    const std::chrono::duration<double> makespan_s{ makespan };
+    std::cout << "\nTotal elapsed time: " << std::chrono::duration_cast<std::chrono::milliseconds>(makespan)
+        << ", " << confirmed / makespan_s.count() << " tasks per second\n";
+
+    // Tell how busy every worker was over the batch, which can't exceed the makespan per thread
+    double total_busy_ns{ 0.0 };
+    double max_busy_ns{ 0.0 };
+    for (const auto& [worker_id, worker] : workers)
+    {
+        total_busy_ns += worker.thread_busy_ns();
+        max_busy_ns = std::max(max_busy_ns, worker.thread_busy_ns());
+        std::cout << "Worker " << worker_id << ": " << worker.tasks_num << " tasks, "
+            << worker.tasks_num / makespan_s.count() << " tasks per second, busy for "
+            << worker.thread_busy_ns() / 1e6 << " ms per thread of " << worker.threads_num << "\n";
+    }
+
+    // A load imbalance of 1 means every thread of every worker was busy for as long as the others,
+    // the busiest worker bounds the makespan otherwise
+    if (!workers.empty() && total_busy_ns > 0)
+    {
+        const auto mean_busy_ns{ total_busy_ns / workers.size() };
+        std::cout << "Load imbalance: " << max_busy_ns / mean_busy_ns << "\n";
+    }
 
+    // A queueing delay is how long a task has waited from being sent to being started by a worker
+    std::cout << "Queueing delay p50 " << percentile_ms(queueing_delays, 0.5) << " ms, p99 "
+        << percentile_ms(queueing_delays, 0.99) << " ms, max " << percentile_ms(queueing_delays, 1.0) << " ms"
+        << std::endl;
 
     return 0;
-}
\ No newline at end of file
+}
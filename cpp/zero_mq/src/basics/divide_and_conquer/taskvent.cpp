@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <iostream>
+#include <cstdint>
 #include <cstdio>
 #include <random>
 #include <string>
@@ -7,41 +9,72 @@
 
 #include <zmq.hpp>
 
-int main()
+#include "task_protocol.hpp"
+
+// Usage: Ventilator [credit based, 0 or 1] [number of tasks] [max workload in ms] [settle time in s]
+//
+// Tasks are pushed round-robin by default, regardless of how busy workers are.
+// Credit based, workers ask for tasks through a ROUTER instead, each keeping up to its window
+// of requests outstanding, so that every task goes to a worker with free capacity.
+// A batch is of 100 tasks of 1 to 100 ms by default, a max workload of 0 makes the tasks free
+// to measure the distribution alone. Given a settle time, the ventilator waits for that long
+// for the workers to connect rather than for a user to tell they have
+int main(int argc, char* argv[])
 {
+    const auto credit_based{ argc > 1 && std::stoi(argv[1]) != 0 };
+    const auto tasks_num{ argc > 2 ? std::stoull(argv[2]) : 100ULL };
+    const auto max_workload_msec{ std::max(argc > 3 ? std::stoi(argv[3]) : 100, 0) };
+
     zmq::context_t context{};
 
     // Establish a socket to send messages on 
-    zmq::socket_t sender{ context, ZMQ_PUSH };
-    sender.bind("tcp://*:5557");
+    zmq::socket_t sender{ context, credit_based ? ZMQ_ROUTER : ZMQ_PUSH };
+    sender.bind(credit_based ? "tcp://*:5559" : "tcp://*:5557");
 
     // Establish a socket to send a start of batch message
     zmq::socket_t sink{ context, ZMQ_PUSH };
     sink.connect("tcp://localhost:5558");
 
-    // Wait for a manual acknowledgment that all workers are ready to receive tasks for processing
-    std::cout << "Press Enter when the workers are ready: ";
-    std::getchar();
+    if (argc > 4)
+    {
+        // Give all workers time to connect, so that round-robin doesn't skip any of them
+        std::this_thread::sleep_for(std::chrono::seconds{ std::stoi(argv[4]) });
+    }
+    else
+    {
+        // Wait for a manual acknowledgment that all workers are ready to receive tasks for processing
+        std::cout << "Press Enter when the workers are ready: ";
+        std::getchar();
+    }
     std::cout << "Sending tasks to workers..." << std::endl;
 
-    // Signal a start of a batch
-    auto start_message{ zmq::str_buffer("0") };
+    // Signal a start of a batch, which tells the sink how many confirmations to wait for
+    auto start_message{ encode(batch_start{ tasks_num, task_clock_ns() }) };
     zmq::send_flags start_message_flags{};
     sink.send(start_message, start_message_flags);
 
-    auto total_msec{ 0 };
+    std::uint64_t total_msec{ 0 };
 
-    // Generate and send 100 tasks for a random workload of 1 to 100 msec.
-    constexpr auto kTasksNumber{ 100 };
+    // Generate and send tasks of a random workload
     std::default_random_engine generator{};
-    std::uniform_int_distribution distribution{ 1, 100 };
-    for (auto t{ 0 }; t < kTasksNumber; ++t)
+    std::uniform_int_distribution distribution{ std::min(1, max_workload_msec), max_workload_msec };
+    for (std::uint64_t t{ 0 }; t < tasks_num; ++t)
     {
         const auto workload_msec{ distribution(generator) };
         total_msec += workload_msec;
 
-        zmq::message_t workload_message{ std::to_string(workload_msec) };
         zmq::send_flags workload_message_flags{};
+        if (credit_based)
+        {
+            // Wait for a request of a worker and address the task to it
+            zmq::message_t worker_identity{};
+            zmq::message_t request{};
+            const auto identity_status{ sender.recv(worker_identity) };
+            const auto request_status{ sender.recv(request) };
+            sender.send(worker_identity, zmq::send_flags::sndmore);
+        }
+        // Stamp a task as late as possible, so that the sink tells how long it waited for a worker
+        auto workload_message{ encode(task{ task_clock_ns(), static_cast<std::uint32_t>(workload_msec) }) };
         sender.send(workload_message, workload_message_flags);
     }
 
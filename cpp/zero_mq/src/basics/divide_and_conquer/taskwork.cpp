@@ -1,50 +1,190 @@
+#include <cstdint>
 #include <iostream>
+#include <iterator>
+#include <optional>
+#include <random>
 #include <string>
 #include <thread>
 #include <chrono>
+#include <vector>
 
 #include <zmq.hpp>
 
-int main()
+#include "BluntQueue.hpp"
+#include "ThreadStorage.h"
+
+#include "task_protocol.hpp"
+
+// Unwrap a task, a malformed one is taken as free of any workload
+task parse_task(const zmq::message_t& task_message)
 {
-    zmq::context_t context{};
+    task t{ task_clock_ns(), 0 };
+    if (!decode(task_message, t))
+    {
+        std::cerr << "Failed to decode a task of " << task_message.size() << " bytes\n";
+    }
+    return t;
+}
 
-    // Create a socket to receive messages on
-    zmq::socket_t receiver{ context, ZMQ_PULL };
-    receiver.connect("tcp://localhost:5557");
+// Hold on for an amount prescribed by a task and tell how it went
+task_confirmation perform(const task& t, std::uint32_t worker_id, std::uint32_t threads_num)
+{
+    const auto started_ns{ task_clock_ns() };
+    std::this_thread::sleep_for(std::chrono::milliseconds{ t.workload_ms });
+    return task_confirmation{ worker_id, threads_num, t.dispatched_ns, started_ns, task_clock_ns() - started_ns };
+}
 
-    // Create a socket to send messages to
-    zmq::socket_t sender{ context, ZMQ_PUSH };
-    sender.connect("tcp://localhost:5558");
+// Return the credit of a task
+void request_task(zmq::socket_t& receiver, int credits)
+{
+    if (credits > 0)
+    {
+        zmq::send_flags request_flags{};
+        receiver.send(zmq::str_buffer("ready"), request_flags);
+    }
+}
+
+// Process incoming tasks one at a time forever
+void work_alone(zmq::socket_t& receiver, zmq::socket_t& sender, int credits, std::uint32_t worker_id)
+{
+    while (true)
+    {
+        // Receive a task
+        zmq::message_t task_message{};
+        const auto receive_task_status{ receiver.recv(task_message) };
+
+        const auto confirmation{ perform(parse_task(task_message), worker_id, 1) };
+
+        // Notify that the job is done
+        auto confirmation_message{ encode(&confirmation, 1) };
+        zmq::send_flags send_flags{};
+        sender.send(confirmation_message, send_flags);
+
+        request_task(receiver, credits);
+    }
+}
+
+// Receive tasks on this thread, which owns both sockets, and hand them over to compute threads
+// through a bounded queue. Tasks done meanwhile are reported to the sink in batches of their
+// confirmations within a single message. A compute thread wakes this one up through an in-process
+// socket once it's done with a task, so that confirmations and credits go out right away,
+// and a task, which doesn't fit the queue, is held here rather than blocking the sockets
+void work_in_pool(zmq::context_t& context, zmq::socket_t& receiver, zmq::socket_t& sender, int credits,
+    unsigned threads_num, std::uint32_t worker_id)
+{
+    BluntQueue<task> tasks{ QueueCapacity{ 2 * threads_num } };
+    BluntQueue<task_confirmation> done{};
+
+    zmq::socket_t wakeups{ context, ZMQ_PULL };
+    wakeups.bind("inproc://done");
+
+    ThreadStorage threads{ threads_num };
+    for (auto t{ 0U }; t < threads_num; ++t)
+    {
+        threads.start(t, [&context, &tasks, &done, worker_id, threads_num]()
+        {
+            zmq::socket_t wakeup{ context, ZMQ_PUSH };
+            wakeup.connect("inproc://done");
+
+            task next{};
+            while (tasks.wait_and_pop(next))
+            {
+                done.push(perform(next, worker_id, threads_num));
+                zmq::send_flags wakeup_flags{};
+                wakeup.send(zmq::str_buffer(""), wakeup_flags);
+            }
+        });
+    }
 
-    // Process incoming tasks forever
+    std::vector<task_confirmation> finished{};
+    std::optional<task> pending{};
+    zmq::pollitem_t items[]{
+        { receiver.handle(), 0, ZMQ_POLLIN, 0 },
+        { wakeups.handle(), 0, ZMQ_POLLIN, 0 } };
     while (true)
     {
-        // Receive a delay in milliseconds
-        zmq::message_t delay_as_string{};
-        const auto receive_delay_status{ receiver.recv(delay_as_string) };
+        // Leave new tasks be while one of them is pending, a compute thread wakes this one up
+        // once it makes room for the pending task
+        items[0].events = static_cast<short>(pending ? 0 : ZMQ_POLLIN);
+        zmq::poll(items, 2, std::chrono::milliseconds{ -1 });
+
+        if (items[1].revents & ZMQ_POLLIN)
+        {
+            zmq::message_t wakeup_message{};
+            while (wakeups.recv(wakeup_message, zmq::recv_flags::dontwait))
+            {
+                // Every wakeup is accounted by draining the confirmations at once below
+            }
+        }
+
+        constexpr std::size_t kMaxBatch{ 1024 };
+        finished.clear();
+        done.try_pop_bulk(std::back_inserter(finished), kMaxBatch);
+        if (!finished.empty())
+        {
+            // Notify that the jobs are done
+            auto batch_message{ encode(finished.data(), finished.size()) };
+            zmq::send_flags send_flags{};
+            sender.send(batch_message, send_flags);
 
-        // Indicate progress for a viewer
-        std::cout << delay_as_string.to_string() << ".";
+            for (std::size_t f{ 0 }; f < finished.size(); ++f)
+            {
+                request_task(receiver, credits);
+            }
+        }
 
-        // Unwrap the delay
-        int delay_ms{};
-        try
+        if (!pending && (items[0].revents & ZMQ_POLLIN))
         {
-            delay_ms = std::stoi(delay_as_string.to_string());
+            zmq::message_t task_message{};
+            const auto receive_task_status{ receiver.recv(task_message) };
+            pending = parse_task(task_message);
         }
-        catch (const std::exception&)
+        if (pending && tasks.try_push(std::move(*pending)))
         {
-            std::cerr << "Failed to cast " << delay_ms << " to a millisecond interval\n";
+            pending.reset();
         }
+    }
+}
 
-        // Hold on for an amount prescribed by the delay
-        std::this_thread::sleep_for(std::chrono::milliseconds{ delay_ms });
+// Usage: Worker [credits] [compute threads]
+//
+// Tasks are pulled as they are pushed by default. Given credits, which are to match
+// the mode of the ventilator, the worker asks for as many tasks up front and for another one
+// once it's done with one, so that it never holds more tasks than it's allowed to.
+// Given compute threads, a single worker process runs that many tasks at once.
+// Every confirmation carries a random identity of the worker, which is shared by its threads
+int main(int argc, char* argv[])
+{
+    const auto credits{ argc > 1 ? std::stoi(argv[1]) : 0 };
+    const auto threads_num{ argc > 2 ? std::stoi(argv[2]) : 0 };
 
-        // Notify that the job is done
-        zmq::send_flags send_flags{};
-        sender.send(zmq::str_buffer(""), send_flags);
+    const auto worker_id{ static_cast<std::uint32_t>(std::random_device{}()) };
+    std::cout << "Worker " << worker_id << std::endl;
+
+    zmq::context_t context{};
+
+    // Create a socket to receive messages on
+    zmq::socket_t receiver{ context, credits > 0 ? ZMQ_DEALER : ZMQ_PULL };
+    receiver.connect(credits > 0 ? "tcp://localhost:5559" : "tcp://localhost:5557");
+
+    // Hand the credits over to the ventilator
+    for (auto c{ 0 }; c < credits; ++c)
+    {
+        request_task(receiver, credits);
+    }
+
+    // Create a socket to send messages to
+    zmq::socket_t sender{ context, ZMQ_PUSH };
+    sender.connect("tcp://localhost:5558");
+
+    if (threads_num > 0)
+    {
+        work_in_pool(context, receiver, sender, credits, static_cast<unsigned>(threads_num), worker_id);
+    }
+    else
+    {
+        work_alone(receiver, sender, credits, worker_id);
     }
 
     return 0;
-}
\ No newline at end of file
+}
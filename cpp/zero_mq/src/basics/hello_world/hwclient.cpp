@@ -1,11 +1,18 @@
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <zmq.hpp>
 
-int main() {
-    //  Prepare our context and socket
-    constexpr auto io_threads_num{ 1 };
-    zmq::context_t context{ io_threads_num };
+using clock_type = std::chrono::steady_clock;
+
+//  Send requests one at a time, which measures a round trip rather than the capacity of a server
+void lockstep(zmq::context_t& context) {
     zmq::socket_t socket{ context, ZMQ_REQ };
     socket.connect("tcp://localhost:5555");
 
@@ -22,6 +29,103 @@ int main() {
         const auto reply_status{ socket.recv(reply) };
         std::cout << "Received " << reply.to_string() << std::endl;
     }
+}
+
+//  Keep a window of requests in flight, each tagged with its sequence number,
+//  and collect the latency of every one of them in nanoseconds
+std::vector<std::int64_t> pipeline(zmq::context_t& context, std::uint64_t requests_num, std::uint64_t window) {
+    zmq::socket_t socket{ context, ZMQ_DEALER };
+    socket.connect("tcp://localhost:5555");
+
+    std::vector<clock_type::time_point> sent(requests_num);
+    std::vector<std::int64_t> latencies{};
+    latencies.reserve(requests_num);
+
+    const std::string r{ "Hello" };
+    std::uint64_t next{ 0 };
+    while (latencies.size() < requests_num) {
+        //  Top the window up
+        while (next < requests_num && next - latencies.size() < window) {
+            //  A DEALER speaks to REP through an empty delimiter frame
+            socket.send(zmq::message_t{}, zmq::send_flags::sndmore);
+            socket.send(zmq::message_t{ &next, sizeof(next) }, zmq::send_flags::sndmore);
+            sent[next] = clock_type::now();
+            socket.send(zmq::message_t{ r.cbegin(), r.cend() }, zmq::send_flags::none);
+            ++next;
+        }
+
+        //  Wait for a reply of the delimiter, the tag and the body
+        zmq::message_t delimiter{};
+        zmq::message_t tag{};
+        zmq::message_t reply{};
+        const auto delimiter_status{ socket.recv(delimiter) };
+        const auto tag_status{ socket.recv(tag) };
+        const auto reply_status{ socket.recv(reply) };
+
+        std::uint64_t sequence{};
+        if (tag.size() != sizeof(sequence)) {
+            std::cerr << "Failed to match a reply of " << tag.size() << " bytes of a tag\n";
+            continue;
+        }
+        std::memcpy(&sequence, tag.data(), sizeof(sequence));
+        if (sequence < requests_num) {
+            latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - sent[sequence]).count());
+        }
+    }
+    return latencies;
+}
+
+double percentile_us(std::vector<std::int64_t>& latencies, double fraction) {
+    if (latencies.empty()) {
+        return 0.0;
+    }
+    const auto rank{ std::min(latencies.size() - 1, static_cast<std::size_t>(fraction * latencies.size())) };
+    std::nth_element(latencies.begin(), latencies.begin() + rank, latencies.end());
+    return latencies[rank] / 1000.0;
+}
+
+//  Usage: Client [number of requests] [requests in flight per thread] [number of threads]
+//
+//  Without arguments the client sends ten requests in lockstep. Otherwise every thread
+//  pipelines its share of the requests through a DEALER socket of its own
+int main(int argc, char* argv[]) {
+    //  Prepare our context and socket
+    constexpr auto io_threads_num{ 1 };
+    zmq::context_t context{ io_threads_num };
+
+    if (argc < 2) {
+        lockstep(context);
+        return 0;
+    }
+
+    const auto requests_num{ std::stoull(argv[1]) };
+    const auto window{ std::max<std::uint64_t>(argc > 2 ? std::stoull(argv[2]) : 64, 1) };
+    const auto threads_num{ std::max<std::uint64_t>(argc > 3 ? std::stoull(argv[3]) : 1, 1) };
+
+    const auto start{ clock_type::now() };
+    std::vector<std::vector<std::int64_t>> results(threads_num);
+    std::vector<std::thread> threads{};
+    for (std::uint64_t t{ 0 }; t < threads_num; ++t) {
+        //  Spread the remainder over the first threads
+        const auto share{ requests_num / threads_num + (t < requests_num % threads_num ? 1 : 0) };
+        threads.emplace_back([&context, &results, t, share, window]() {
+            results[t] = pipeline(context, share, window);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const std::chrono::duration<double> elapsed{ clock_type::now() - start };
+
+    std::vector<std::int64_t> latencies{};
+    for (const auto& result : results) {
+        latencies.insert(latencies.end(), result.cbegin(), result.cend());
+    }
+
+    std::cout << "Completed " << latencies.size() << " requests in " << elapsed.count() << " s, "
+        << latencies.size() / elapsed.count() << " requests per second\n"
+        << "Latency p50 " << percentile_us(latencies, 0.5) << " us, p99 " << percentile_us(latencies, 0.99)
+        << " us, p999 " << percentile_us(latencies, 0.999) << " us" << std::endl;
 
     return 0;
-}
\ No newline at end of file
+}
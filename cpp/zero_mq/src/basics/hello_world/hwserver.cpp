@@ -1,33 +1,100 @@
 #include <iostream>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <thread>
 #include <cstring>
 #include <string>
+#include <vector>
 
 #include <zmq.hpp>
 
-int main() {
-    //  Prepare our context and socket
-    constexpr auto io_threads_num{ 1 };
-    zmq::context_t context{ io_threads_num };
-    zmq::socket_t socket{ context, ZMQ_REP };
-    socket.bind("tcp://*:5555");
-
+//  Answer requests arriving at a REP socket, which is bound or connected by the caller.
+//  A request of two frames carries a tag, which is sent back within the reply,
+//  so that pipelining clients are able to match replies
+void serve(zmq::socket_t& socket, std::atomic<std::uint64_t>& served) {
+    const std::string r{ "World" };
     while (true) {
         //  Wait for next request from client
         zmq::message_t request{};
         const auto request_status{ socket.recv(request) };
-        std::cout << "Received " << request.to_string() << std::endl;
+        if (!request_status) {
+            continue;
+        }
+        zmq::message_t tag{};
+        const auto tagged{ request.more() };
+        if (tagged) {
+            tag.move(request);
+            const auto body_status{ socket.recv(request) };
+        }
 
         //  Do some 'work'
         std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
 
         //  Send reply back to client
-        const std::string r{ "World" };
+        if (tagged) {
+            socket.send(tag, zmq::send_flags::sndmore);
+        }
         zmq::message_t reply{ r.cbegin(), r.cend() };
         zmq::send_flags flags{};
         socket.send(reply, flags);
+        served.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+//  Tell the throughput once a second, so that the console stays off the request path
+void report(const std::atomic<std::uint64_t>& served) {
+    auto last{ served.load(std::memory_order_relaxed) };
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::seconds{ 1 });
+        const auto now{ served.load(std::memory_order_relaxed) };
+        std::cout << "Served " << now - last << " requests per second\n" << std::flush;
+        last = now;
+    }
+}
+
+//  Usage: Server [number of workers]
+//
+//  Without workers a single REP socket serves clients. With workers a ROUTER frontend
+//  spreads requests over REP worker threads through an in-process DEALER backend,
+//  so that the service scales with cores
+int main(int argc, char* argv[]) {
+    const auto workers_num{ argc > 1 ? std::stoi(argv[1]) : 0 };
+
+    //  Prepare our context and socket
+    constexpr auto io_threads_num{ 1 };
+    zmq::context_t context{ io_threads_num };
+    std::atomic<std::uint64_t> served{ 0 };
+    std::thread reporter{ report, std::cref(served) };
+
+    if (workers_num <= 0) {
+        zmq::socket_t socket{ context, ZMQ_REP };
+        socket.bind("tcp://*:5555");
+        serve(socket, served);
+    }
+
+    //  Clients talk to the frontend, workers to the backend
+    zmq::socket_t frontend{ context, ZMQ_ROUTER };
+    frontend.bind("tcp://*:5555");
+    zmq::socket_t backend{ context, ZMQ_DEALER };
+    backend.bind("inproc://workers");
+
+    std::vector<std::thread> workers{};
+    for (auto i{ 0 }; i < workers_num; ++i) {
+        workers.emplace_back([&context, &served]() {
+            zmq::socket_t socket{ context, ZMQ_REP };
+            socket.connect("inproc://workers");
+            serve(socket, served);
+        });
+    }
+
+    //  Shuttle requests to workers and replies back to clients
+    zmq::proxy(frontend, backend);
+
+    for (auto& worker : workers) {
+        worker.join();
     }
+    reporter.join();
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,277 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+//  A broadcast ring within shared memory: a single writer publishes frames into slots,
+//  and any number of readers of the same host follow it, each at a cursor of its own.
+//  The writer never waits for readers, so a reader falling a whole ring behind is overrun,
+//  which it detects and recovers from by skipping to the oldest frame still available.
+//
+//  Every slot is guarded by a version, which is odd while the slot is being written
+//  and tells the sequence number of its frame otherwise: a reader checks the version
+//  before and after looking at a frame, so a frame, which has been overwritten meanwhile,
+//  is discarded rather than taken torn. Neither side makes a system call or copies a frame
+//  through the kernel, a reader looks at frames right within the ring
+class shm_ring {
+public:
+    static constexpr std::size_t kCacheLineSize{ 64 };
+
+    //  Outcomes of a read
+    enum class read_status {
+        read,
+        empty,
+        overrun
+    };
+
+    shm_ring(const shm_ring&) = delete;
+    shm_ring& operator=(const shm_ring&) = delete;
+
+    //  Create a ring of a name as its writer, the ring is removed once the writer is gone
+    static shm_ring create(const std::string& name, std::size_t slot_size, std::size_t slots_num) {
+        const auto payload{ align(slot_size) };
+        const auto stride{ kSlotHeaderSize + payload };
+        const auto size{ kHeaderSize + stride * slots_num };
+        shm_ring ring{ name, size, true };
+
+        auto* header{ new (ring.memory_) ring_header{} };
+        header->slot_size = slot_size;
+        header->slots_num = slots_num;
+        header->stride = stride;
+        for (std::size_t s{ 0 }; s < slots_num; ++s) {
+            new (ring.slot(header, s)) slot_header{};
+        }
+        //  Readers don't look into a ring till it's complete
+        header->magic.store(kMagic, std::memory_order_release);
+        return ring;
+    }
+
+    //  Open a ring of a name as its reader, which starts at the frame to come next
+    static shm_ring open(const std::string& name) {
+        shm_ring ring{ name, 0, false };
+        if (ring.header()->magic.load(std::memory_order_acquire) != kMagic) {
+            throw std::runtime_error{ "Shared memory " + name + " holds no ring" };
+        }
+        ring.cursor_ = ring.header()->head.load(std::memory_order_acquire);
+        return ring;
+    }
+
+    shm_ring(shm_ring&& other) noexcept :
+        name_{ std::move(other.name_) },
+        memory_{ other.memory_ },
+        size_{ other.size_ },
+        owner_{ other.owner_ },
+        cursor_{ other.cursor_ }
+#if defined(_WIN32)
+        , mapping_{ other.mapping_ }
+#endif
+    {
+        other.memory_ = nullptr;
+        other.owner_ = false;
+#if defined(_WIN32)
+        other.mapping_ = nullptr;
+#endif
+    }
+
+    ~shm_ring() {
+        if (memory_ == nullptr) {
+            return;
+        }
+#if defined(_WIN32)
+        UnmapViewOfFile(memory_);
+        CloseHandle(mapping_);
+#else
+        munmap(memory_, size_);
+        if (owner_) {
+            shm_unlink(name_.c_str());
+        }
+#endif
+    }
+
+    std::size_t slot_size() const {
+        return header()->slot_size;
+    }
+
+    //  Publish a frame telling whether it fits a slot
+    bool write(const void* data, std::size_t size) {
+        auto* ring{ header() };
+        if (size > ring->slot_size) {
+            return false;
+        }
+
+        const auto sequence{ ring->head.load(std::memory_order_relaxed) };
+        auto* target{ slot(ring, sequence % ring->slots_num) };
+        target->version.store(2 * sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        target->size = size;
+        std::memcpy(payload(target), data, size);
+        target->version.store(2 * sequence + 2, std::memory_order_release);
+        ring->head.store(sequence + 1, std::memory_order_release);
+        return true;
+    }
+
+    //  Look at the next frame right within the ring. A visitor is to take what it needs out of a frame
+    //  without acting upon it, since the frame may turn out to be overwritten while it's been looked at,
+    //  which is told by an overrun. Skipped frames are added to a counter of the lost ones
+    template <typename Visitor>
+    read_status read(Visitor visit, std::uint64_t& lost) {
+        auto* ring{ header() };
+        const auto head{ ring->head.load(std::memory_order_acquire) };
+        if (cursor_ == head) {
+            return read_status::empty;
+        }
+        if (head - cursor_ > ring->slots_num) {
+            lost += head - ring->slots_num - cursor_;
+            cursor_ = head - ring->slots_num;
+        }
+
+        const auto* source{ slot(ring, cursor_ % ring->slots_num) };
+        const auto expected{ 2 * cursor_ + 2 };
+        if (source->version.load(std::memory_order_acquire) != expected) {
+            ++lost;
+            ++cursor_;
+            return read_status::overrun;
+        }
+        const auto size{ std::min(source->size, ring->slot_size) };
+        visit(payload(source), size);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (source->version.load(std::memory_order_relaxed) != expected) {
+            ++lost;
+            ++cursor_;
+            return read_status::overrun;
+        }
+
+        ++cursor_;
+        return read_status::read;
+    }
+
+private:
+    static constexpr std::uint64_t kMagic{ 0x676E697257534D5AULL };
+
+    struct ring_header {
+        std::atomic<std::uint64_t> magic{ 0 };
+        std::size_t slot_size{ 0 };
+        std::size_t slots_num{ 0 };
+        std::size_t stride{ 0 };
+        //  The writer updates the head alone, keep readers of the rest from sharing its line
+        alignas(kCacheLineSize) std::atomic<std::uint64_t> head{ 0 };
+    };
+
+    struct alignas(kCacheLineSize) slot_header {
+        std::atomic<std::uint64_t> version{ 0 };
+        std::size_t size{ 0 };
+    };
+
+    static constexpr std::size_t align(std::size_t size) {
+        return (size + kCacheLineSize - 1) / kCacheLineSize * kCacheLineSize;
+    }
+
+    //  Both headers are padded to cache lines, and so are the slots
+    static constexpr std::size_t kHeaderSize{ sizeof(ring_header) };
+    static constexpr std::size_t kSlotHeaderSize{ sizeof(slot_header) };
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Expecting processes to share atomics without locks");
+
+    shm_ring(const std::string& name, std::size_t size, bool owner) :
+        name_{ name },
+        memory_{ nullptr },
+        size_{ size },
+        owner_{ owner },
+        cursor_{ 0 } {
+#if defined(_WIN32)
+        mapping_ = owner ?
+            CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                static_cast<DWORD>(static_cast<std::uint64_t>(size) >> 32), static_cast<DWORD>(size), name.c_str()) :
+            OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+        if (mapping_ == nullptr) {
+            throw std::runtime_error{ "Failed to map shared memory " + name };
+        }
+        memory_ = MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, size);
+        if (memory_ == nullptr) {
+            CloseHandle(mapping_);
+            throw std::runtime_error{ "Failed to map shared memory " + name };
+        }
+#else
+        const auto descriptor{ shm_open(name.c_str(), owner ? O_CREAT | O_RDWR | O_TRUNC : O_RDWR, 0600) };
+        if (descriptor < 0) {
+            throw std::runtime_error{ "Failed to open shared memory " + name };
+        }
+        if (owner && ftruncate(descriptor, static_cast<off_t>(size)) != 0) {
+            close(descriptor);
+            shm_unlink(name.c_str());
+            throw std::runtime_error{ "Failed to size shared memory " + name };
+        }
+        if (!owner) {
+            //  A reader maps the header first to learn the size of the ring
+            auto* probe{ mmap(nullptr, kHeaderSize, PROT_READ, MAP_SHARED, descriptor, 0) };
+            if (probe == MAP_FAILED) {
+                close(descriptor);
+                throw std::runtime_error{ "Failed to map shared memory " + name };
+            }
+            const auto* header{ static_cast<const ring_header*>(probe) };
+            const auto complete{ header->magic.load(std::memory_order_acquire) == kMagic };
+            size_ = kHeaderSize + header->stride * header->slots_num;
+            munmap(probe, kHeaderSize);
+            if (!complete) {
+                close(descriptor);
+                throw std::runtime_error{ "Shared memory " + name + " holds no ring" };
+            }
+        }
+        auto* memory{ mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0) };
+        close(descriptor);
+        if (memory == MAP_FAILED) {
+            if (owner) {
+                shm_unlink(name.c_str());
+            }
+            throw std::runtime_error{ "Failed to map shared memory " + name };
+        }
+        memory_ = memory;
+#endif
+    }
+
+    ring_header* header() const {
+        return static_cast<ring_header*>(memory_);
+    }
+
+    slot_header* slot(ring_header* ring, std::size_t index) const {
+        return reinterpret_cast<slot_header*>(static_cast<unsigned char*>(memory_) + kHeaderSize + index * ring->stride);
+    }
+
+    static unsigned char* payload(slot_header* target) {
+        return reinterpret_cast<unsigned char*>(target) + kSlotHeaderSize;
+    }
+
+    static const unsigned char* payload(const slot_header* source) {
+        return reinterpret_cast<const unsigned char*>(source) + kSlotHeaderSize;
+    }
+
+    std::string name_;
+    void* memory_;
+    std::size_t size_;
+    bool owner_;
+    std::uint64_t cursor_;
+#if defined(_WIN32)
+    HANDLE mapping_{ nullptr };
+#endif
+};
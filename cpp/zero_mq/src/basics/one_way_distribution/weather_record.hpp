@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <zmq.hpp>
+
+//  A weather update on the wire: a zipcode as five ASCII digits padded with zeros,
+//  so that subscribers keep filtering updates by zipcode prefixes, followed by
+//  the temperature and the relative humidity as little-endian IEEE floats
+struct weather_record {
+    int zipcode;
+    float temperature;
+    float relative_humidity;
+};
+
+constexpr std::size_t kZipcodeDigits{ 5 };
+constexpr std::size_t kWeatherRecordSize{ kZipcodeDigits + 2 * sizeof(std::uint32_t) };
+constexpr int kMaxZipcode{ 99999 };
+
+static_assert(sizeof(float) == sizeof(std::uint32_t), "Expecting floats of 32 bits");
+
+inline void store_float(unsigned char* destination, float value) {
+    const auto bits{ std::bit_cast<std::uint32_t>(value) };
+    for (std::size_t b{ 0 }; b < sizeof(bits); ++b) {
+        destination[b] = static_cast<unsigned char>(bits >> (8 * b));
+    }
+}
+
+inline float load_float(const unsigned char* source) {
+    std::uint32_t bits{ 0 };
+    for (std::size_t b{ 0 }; b < sizeof(bits); ++b) {
+        bits |= static_cast<std::uint32_t>(source[b]) << (8 * b);
+    }
+    return std::bit_cast<float>(bits);
+}
+
+//  Lay an update out at a place of the size of a record
+inline void encode(const weather_record& record, unsigned char* data) {
+    auto zipcode{ std::clamp(record.zipcode, 0, kMaxZipcode) };
+    for (auto d{ kZipcodeDigits }; d > 0; --d) {
+        data[d - 1] = static_cast<unsigned char>('0' + zipcode % 10);
+        zipcode /= 10;
+    }
+    store_float(data + kZipcodeDigits, record.temperature);
+    store_float(data + kZipcodeDigits + sizeof(std::uint32_t), record.relative_humidity);
+}
+
+//  Build an update right within a message
+inline zmq::message_t encode(const weather_record& record) {
+    zmq::message_t message{ kWeatherRecordSize };
+    encode(record, static_cast<unsigned char*>(message.data()));
+    return message;
+}
+
+//  Read an update from a place of the size of a record
+inline weather_record decode(const unsigned char* data) {
+    weather_record record{};
+    for (std::size_t d{ 0 }; d < kZipcodeDigits; ++d) {
+        record.zipcode = record.zipcode * 10 + (data[d] - '0');
+    }
+    record.temperature = load_float(data + kZipcodeDigits);
+    record.relative_humidity = load_float(data + kZipcodeDigits + sizeof(std::uint32_t));
+    return record;
+}
+
+//  Read an update right from a message, which is to be of the size of a record
+inline weather_record decode(const zmq::message_t& message) {
+    return decode(static_cast<const unsigned char*>(message.data()));
+}
+
+//  A batch of updates sharing a topic, which is the first digits of their zipcodes:
+//  the topic, a marker keeping batches apart from single updates for subscribers,
+//  a little-endian 16-bit count and the records back to back
+constexpr std::size_t kTopicDigits{ 2 };
+constexpr std::size_t kTopicsNum{ 100 };
+constexpr char kBatchMarker{ '#' };
+constexpr std::size_t kBatchHeaderSize{ kTopicDigits + 1 + sizeof(std::uint16_t) };
+constexpr std::size_t kMaxBatchRecords{ 0xFFFF };
+
+inline std::size_t topic_of(const weather_record& record) {
+    auto zipcode{ std::clamp(record.zipcode, 0, kMaxZipcode) };
+    for (auto d{ kZipcodeDigits }; d > kTopicDigits; --d) {
+        zipcode /= 10;
+    }
+    return static_cast<std::size_t>(zipcode);
+}
+
+//  Whether a zipcode starts with a prefix of digits, as a subscription would tell
+inline bool zipcode_matches(int zipcode, const std::string& prefix) {
+    char digits[kZipcodeDigits]{};
+    auto value{ std::clamp(zipcode, 0, kMaxZipcode) };
+    for (auto d{ kZipcodeDigits }; d > 0; --d) {
+        digits[d - 1] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    return prefix.size() <= kZipcodeDigits && prefix.compare(0, prefix.size(), digits, prefix.size()) == 0;
+}
+
+//  A subscription to batches of a topic, which is the start of a zipcode filter
+inline std::string batch_subscription(const std::string& zipcode_filter) {
+    return zipcode_filter.substr(0, kTopicDigits) + kBatchMarker;
+}
+
+//  A batch of a topic being filled right within its message
+class weather_batch {
+public:
+    weather_batch(std::size_t topic, std::size_t capacity) :
+        message_{ kBatchHeaderSize + std::clamp<std::size_t>(capacity, 1, kMaxBatchRecords) * kWeatherRecordSize },
+        topic_{ topic },
+        size_{ 0 } {
+        reset();
+    }
+
+    //  Add an update telling whether the batch is full
+    bool add(const weather_record& record) {
+        encode(record, data() + kBatchHeaderSize + size_ * kWeatherRecordSize);
+        ++size_;
+        return size_ == capacity();
+    }
+
+    //  Hand the filled message over, and start a new one of the same capacity
+    zmq::message_t take() {
+        auto* data_ptr{ data() };
+        data_ptr[kTopicDigits + 1] = static_cast<unsigned char>(size_);
+        data_ptr[kTopicDigits + 2] = static_cast<unsigned char>(size_ >> 8);
+
+        zmq::message_t full{ message_.size() };
+        full.swap(message_);
+        size_ = 0;
+        reset();
+        return full;
+    }
+
+private:
+    unsigned char* data() {
+        return static_cast<unsigned char*>(message_.data());
+    }
+
+    std::size_t capacity() const {
+        return (message_.size() - kBatchHeaderSize) / kWeatherRecordSize;
+    }
+
+    void reset() {
+        auto* data_ptr{ data() };
+        auto topic{ topic_ };
+        for (auto d{ kTopicDigits }; d > 0; --d) {
+            data_ptr[d - 1] = static_cast<unsigned char>('0' + topic % 10);
+            topic /= 10;
+        }
+        data_ptr[kTopicDigits] = static_cast<unsigned char>(kBatchMarker);
+    }
+
+    zmq::message_t message_;
+    std::size_t topic_;
+    std::size_t size_;
+};
+
+//  Visit every update of a message, whether it's a single update or a batch of them,
+//  right within the message. Tell the number of the updates, or zero for a malformed message
+template <typename Visitor>
+std::size_t for_each_record(const unsigned char* data, std::size_t size, Visitor visit) {
+    if (size == kWeatherRecordSize && data[kTopicDigits] != kBatchMarker) {
+        visit(decode(data));
+        return 1;
+    }
+
+    if (size < kBatchHeaderSize || data[kTopicDigits] != kBatchMarker) {
+        return 0;
+    }
+    const std::size_t count{ static_cast<std::size_t>(data[kTopicDigits + 1]) |
+        (static_cast<std::size_t>(data[kTopicDigits + 2]) << 8) };
+    if (size < kBatchHeaderSize + count * kWeatherRecordSize) {
+        return 0;
+    }
+    for (std::size_t r{ 0 }; r < count; ++r) {
+        visit(decode(data + kBatchHeaderSize + r * kWeatherRecordSize));
+    }
+    return count;
+}
+
+template <typename Visitor>
+std::size_t for_each_record(const zmq::message_t& message, Visitor visit) {
+    return for_each_record(static_cast<const unsigned char*>(message.data()), message.size(), visit);
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WEATHER_STATS_SSE2
+#endif
+
+//  Statistics of a zipcode as of a snapshot
+struct zipcode_stats {
+    int zipcode;
+    std::uint64_t count;
+    double mean;
+    double variance;
+    float min;
+    float max;
+};
+
+//  Running temperature statistics of a range of zipcodes kept as a structure of arrays,
+//  a dense array per statistic indexed by zipcode, so that the kernels over them stream
+//  through memory and vectorize
+class weather_stats {
+public:
+    weather_stats(int first_zipcode, int last_zipcode) :
+        first_{ first_zipcode },
+        counts_(static_cast<std::size_t>(last_zipcode - first_zipcode + 1), 0),
+        sums_(counts_.size(), 0.0),
+        squares_(counts_.size(), 0.0),
+        mins_(counts_.size(), std::numeric_limits<float>::max()),
+        maxs_(counts_.size(), std::numeric_limits<float>::lowest()),
+        doubles_{},
+        squared_{} {
+    }
+
+    bool covers(int zipcode) const {
+        return zipcode >= first_ && static_cast<std::size_t>(zipcode - first_) < counts_.size();
+    }
+
+    //  Account a batch of updates given as offsets of their zipcodes within the range and temperatures.
+    //  Updates scatter over zipcodes, so the arithmetic is done by a vector pass over the batch
+    //  and the result is scattered into the table
+    void add(const std::uint32_t* offsets, const float* temperatures, std::size_t count) {
+        doubles_.resize(count);
+        squared_.resize(count);
+        widen_and_square(temperatures, doubles_.data(), squared_.data(), count);
+
+        for (std::size_t u{ 0 }; u < count; ++u) {
+            const auto o{ offsets[u] };
+            ++counts_[o];
+            sums_[o] += doubles_[u];
+            squares_[o] += squared_[u];
+            mins_[o] = std::min(mins_[o], temperatures[u]);
+            maxs_[o] = std::max(maxs_[o], temperatures[u]);
+        }
+    }
+
+    //  Statistics of every zipcode, which has been reported
+    std::vector<zipcode_stats> snapshot() const {
+        std::vector<double> means(counts_.size());
+        std::vector<double> variances(counts_.size());
+        moments(means.data(), variances.data());
+
+        std::vector<zipcode_stats> stats{};
+        for (std::size_t z{ 0 }; z < counts_.size(); ++z) {
+            if (counts_[z] != 0) {
+                stats.push_back(zipcode_stats{ first_ + static_cast<int>(z), counts_[z], means[z], variances[z], mins_[z], maxs_[z] });
+            }
+        }
+        return stats;
+    }
+
+private:
+    static void widen_and_square(const float* values, double* widened, double* squared, std::size_t count) {
+        std::size_t v{ 0 };
+#if defined(WEATHER_STATS_SSE2)
+        for (; v + 4 <= count; v += 4) {
+            const auto four{ _mm_loadu_ps(values + v) };
+            const auto low{ _mm_cvtps_pd(four) };
+            const auto high{ _mm_cvtps_pd(_mm_movehl_ps(four, four)) };
+            _mm_storeu_pd(widened + v, low);
+            _mm_storeu_pd(widened + v + 2, high);
+            _mm_storeu_pd(squared + v, _mm_mul_pd(low, low));
+            _mm_storeu_pd(squared + v + 2, _mm_mul_pd(high, high));
+        }
+#endif
+        for (; v < count; ++v) {
+            widened[v] = values[v];
+            squared[v] = widened[v] * widened[v];
+        }
+    }
+
+    //  Means and variances of the whole table in a single pass, empty zipcodes yield garbage to be skipped
+    void moments(double* means, double* variances) const {
+        const auto size{ counts_.size() };
+        std::size_t z{ 0 };
+#if defined(WEATHER_STATS_SSE2)
+        const auto one{ _mm_set1_pd(1.0) };
+        for (; z + 2 <= size; z += 2) {
+            const auto counts{ _mm_max_pd(_mm_set_pd(static_cast<double>(counts_[z + 1]), static_cast<double>(counts_[z])), one) };
+            const auto mean{ _mm_div_pd(_mm_loadu_pd(sums_.data() + z), counts) };
+            const auto square_mean{ _mm_div_pd(_mm_loadu_pd(squares_.data() + z), counts) };
+            _mm_storeu_pd(means + z, mean);
+            _mm_storeu_pd(variances + z, _mm_max_pd(_mm_sub_pd(square_mean, _mm_mul_pd(mean, mean)), _mm_setzero_pd()));
+        }
+#endif
+        for (; z < size; ++z) {
+            const auto count{ std::max(static_cast<double>(counts_[z]), 1.0) };
+            means[z] = sums_[z] / count;
+            variances[z] = std::max(squares_[z] / count - means[z] * means[z], 0.0);
+        }
+    }
+
+    int first_;
+    std::vector<std::uint64_t> counts_;
+    std::vector<double> sums_;
+    std::vector<double> squares_;
+    std::vector<float> mins_;
+    std::vector<float> maxs_;
+    //  Scratch room of a batch
+    std::vector<double> doubles_;
+    std::vector<double> squared_;
+};
@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <zmq.hpp>
+
+#include "weather_record.hpp"
+#include "weather_stats.hpp"
+
+//  Usage: Aggregator [first zipcode] [last zipcode] [snapshot period in seconds] [receive high water mark]
+//
+//  Subscribe to every zipcode of a range, keep running temperature statistics of each one,
+//  and tell a snapshot of them periodically
+int main(int argc, char* argv[]) {
+    const auto first_zipcode{ std::clamp(argc > 1 ? std::stoi(argv[1]) : 0, 0, kMaxZipcode) };
+    const auto last_zipcode{ std::clamp(argc > 2 ? std::stoi(argv[2]) : kMaxZipcode, first_zipcode, kMaxZipcode) };
+    const std::chrono::seconds period{ argc > 3 ? std::stoi(argv[3]) : 5 };
+
+    zmq::context_t context{};
+    zmq::socket_t subscriber{ context, ZMQ_SUB };
+    if (argc > 4) {
+        subscriber.set(zmq::sockopt::rcvhwm, std::stoi(argv[4]));
+    }
+    //  Wake up for snapshots while no updates arrive
+    subscriber.set(zmq::sockopt::rcvtimeo, 100);
+    subscriber.connect("tcp://localhost:5556");
+
+    //  A topic prefix covers both the single updates and the batches of its zipcodes,
+    //  the ones of the range are picked from them here
+    const auto first_topic{ topic_of(weather_record{ first_zipcode, 0.0f, 0.0f }) };
+    const auto last_topic{ topic_of(weather_record{ last_zipcode, 0.0f, 0.0f }) };
+    for (auto t{ first_topic }; t <= last_topic; ++t) {
+        const auto topic{ std::to_string(t + kTopicsNum).substr(1) };
+        subscriber.set(zmq::sockopt::subscribe, topic);
+    }
+
+    weather_stats stats{ first_zipcode, last_zipcode };
+    std::vector<std::uint32_t> offsets{};
+    std::vector<float> temperatures{};
+    std::uint64_t updates_num{ 0 };
+    auto next_snapshot{ std::chrono::steady_clock::now() + period };
+    while (true) {
+        zmq::message_t measurements{};
+        const auto status{ subscriber.recv(measurements) };
+        if (status) {
+            //  Gather a batch into columns to be aggregated at once
+            offsets.clear();
+            temperatures.clear();
+            const auto records_num{ for_each_record(measurements, [&](const weather_record& record) {
+                if (stats.covers(record.zipcode)) {
+                    offsets.push_back(static_cast<std::uint32_t>(record.zipcode - first_zipcode));
+                    temperatures.push_back(record.temperature);
+                }
+            }) };
+            if (records_num == 0) {
+                std::cerr << "Failed to decode a measurement of " << measurements.size() << " bytes\n";
+            }
+            stats.add(offsets.data(), temperatures.data(), offsets.size());
+            updates_num += offsets.size();
+        }
+
+        const auto now{ std::chrono::steady_clock::now() };
+        if (now < next_snapshot) {
+            continue;
+        }
+        next_snapshot = now + period;
+
+        const auto snapshot{ stats.snapshot() };
+        if (snapshot.empty()) {
+            std::cout << "No updates from " << first_zipcode << " to " << last_zipcode << " so far\n";
+            continue;
+        }
+        const auto coldest{ std::min_element(snapshot.cbegin(), snapshot.cend(),
+            [](const auto& left, const auto& right) { return left.min < right.min; }) };
+        const auto warmest{ std::max_element(snapshot.cbegin(), snapshot.cend(),
+            [](const auto& left, const auto& right) { return left.max < right.max; }) };
+        const auto busiest{ std::max_element(snapshot.cbegin(), snapshot.cend(),
+            [](const auto& left, const auto& right) { return left.count < right.count; }) };
+        std::cout << updates_num << " updates from " << snapshot.size() << " zipcodes, the coldest "
+            << coldest->min << " at " << coldest->zipcode << ", the warmest " << warmest->max << " at " << warmest->zipcode
+            << ", the busiest " << busiest->zipcode << " with " << busiest->count << " updates averaging "
+            << busiest->mean << " with a variance of " << busiest->variance << "\n" << std::flush;
+    }
+
+    return 0;
+}
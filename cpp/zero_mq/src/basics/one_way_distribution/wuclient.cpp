@@ -1,34 +1,58 @@
-#include <sstream>
 #include <iostream>
+#include <string>
 
 #include <zmq.hpp>
 
+#include "weather_record.hpp"
+
+//  Usage: Client [zipcode prefix] [receive high water mark] [conflate, 0 or 1]
+//
+//  Conflating subscribers keep the latest frame only, which suits the ones
+//  interested in the current weather rather than in every update
 int main(int argc, char* argv[]) {
     zmq::context_t context{};
     zmq::socket_t subscriber{ context, ZMQ_SUB };
+    if (argc > 2) {
+        subscriber.set(zmq::sockopt::rcvhwm, std::stoi(argv[2]));
+    }
+    if (argc > 3) {
+        subscriber.set(zmq::sockopt::conflate, std::stoi(argv[3]) != 0);
+    }
     subscriber.connect("tcp://localhost:5556");
 
-    const auto zipcode_filter{ argc > 1 ? argv[1] : "50000" };
+    //  Single updates are filtered by the publisher, whereas batches of a topic
+    //  carry neighbour zipcodes, which are filtered here
+    const std::string zipcode_filter{ argc > 1 ? argv[1] : "50000" };
     subscriber.set(zmq::sockopt::subscribe, zipcode_filter);
+    subscriber.set(zmq::sockopt::subscribe, batch_subscription(zipcode_filter));
 
     constexpr auto kMaxUpdatesToProcess{ 100U };
     double total_temperature{ 0.0 };
-    for (auto u{ 0U }; u < kMaxUpdatesToProcess; ++u) {
+    auto updates_num{ 0U };
+    while (updates_num < kMaxUpdatesToProcess) {
         zmq::message_t measurements{};
         const auto status{ subscriber.recv(measurements) };
-        std::cout << "A measurement: " << measurements.to_string() << "\n";
-
-        std::istringstream stream{ measurements.to_string() };
-        double zipcode{};
-        double temperature{};
-        double relative_humility{};
-        stream >> zipcode >> temperature >> relative_humility;
 
-        total_temperature += temperature;
+        //  Read the measurements right from the message
+        const auto records_num{ for_each_record(measurements, [&](const weather_record& record) {
+            if (updates_num == kMaxUpdatesToProcess) {
+                return;
+            }
+
+            if (!zipcode_matches(record.zipcode, zipcode_filter)) {
+                return;
+            }
+
+            total_temperature += record.temperature;
+            ++updates_num;
+        }) };
+        if (records_num == 0) {
+            std::cerr << "Failed to decode a measurement of " << measurements.size() << " bytes\n";
+        }
     }
 
-    const auto average_temperature{ total_temperature / kMaxUpdatesToProcess };
+    const auto average_temperature{ updates_num > 0 ? total_temperature / updates_num : 0.0 };
     std::cout << "Average temperature at " << zipcode_filter << " is " << average_temperature << "\n";
 
     return 0;
-}
\ No newline at end of file
+}
@@ -1,13 +1,29 @@
 #include <random>
 #include <algorithm>
+#include <optional>
 #include <string>
-#include <iostream>
+#include <vector>
 
 #include <zmq.hpp>
 
-int main() {
+#include "shm_ring.hpp"
+#include "weather_record.hpp"
+
+//  Usage: Server [updates per frame] [send high water mark] [name of a shared memory ring, e.g. /weather]
+//
+//  A single update is sent per message by default. With more updates per frame,
+//  updates are gathered into a batch per zipcode topic, which goes out once it's full.
+//  Given a name, every frame is broadcast through a shared memory ring as well,
+//  which subscribers of the same host read without any system calls
+int main(int argc, char* argv[]) {
+    const auto batch_size{ argc > 1 ? std::stoul(argv[1]) : 1UL };
+
     zmq::context_t context{};
     zmq::socket_t publisher{ context, ZMQ_PUB };
+    if (argc > 2) {
+        //  Frames beyond the mark are dropped for a slow subscriber instead of piling up
+        publisher.set(zmq::sockopt::sndhwm, std::stoi(argv[2]));
+    }
     publisher.bind("tcp://*:5556");
     publisher.bind("ipc://weather.ipc");
 
@@ -16,20 +32,47 @@ int main() {
     std::normal_distribution<double> temperature_distribution{ 5.8, 10 };
     std::normal_distribution<double> relative_humidity_distribution{ 77, 7 };
 
+    std::optional<shm_ring> ring{};
+    if (argc > 3) {
+        constexpr std::size_t ring_slots_num{ 4096 };
+        const auto frame_size{ batch_size > 1 ? kBatchHeaderSize + batch_size * kWeatherRecordSize : kWeatherRecordSize };
+        ring.emplace(shm_ring::create(argv[3], frame_size, ring_slots_num));
+    }
+    const auto share{ [&ring](const zmq::message_t& message) {
+        if (ring) {
+            ring->write(message.data(), message.size());
+        }
+    } };
+
+    std::vector<weather_batch> batches{};
+    if (batch_size > 1) {
+        for (std::size_t t{ 0 }; t < kTopicsNum; ++t) {
+            batches.emplace_back(t, batch_size);
+        }
+    }
+
     while (true) {
         const int zipcode{ static_cast<int>(std::max(0.0, zipcode_distribution(generator))) };
         const auto temperature{ temperature_distribution(generator) };
         const auto relative_humidity{ std::max(0.0, relative_humidity_distribution(generator)) };
 
-        const std::string measurements{ std::to_string(zipcode) + " " +
-            std::to_string(temperature) + " " +
-            std::to_string(relative_humidity) };
-        std::cout << "A measurement: " << measurements << "\n";
-
-        zmq::message_t message{ measurements.cbegin(), measurements.cend() };
+        //  Lay the measurements out right within a message
+        const weather_record record{ zipcode, static_cast<float>(temperature), static_cast<float>(relative_humidity) };
         const zmq::send_flags flags{};
-        publisher.send(message, flags);
+        if (batches.empty()) {
+            zmq::message_t message{ encode(record) };
+            share(message);
+            publisher.send(message, flags);
+            continue;
+        }
+
+        auto& batch{ batches[topic_of(record)] };
+        if (batch.add(record)) {
+            zmq::message_t message{ batch.take() };
+            share(message);
+            publisher.send(message, flags);
+        }
     }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,58 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "shm_ring.hpp"
+#include "weather_record.hpp"
+
+//  Usage: ShmClient [zipcode prefix] [name of the shared memory ring of the publisher]
+//
+//  Follow the publisher through its shared memory ring rather than a socket,
+//  which takes neither a system call nor a copy per frame while updates keep coming
+int main(int argc, char* argv[]) {
+    const std::string zipcode_filter{ argc > 1 ? argv[1] : "50000" };
+    const std::string ring_name{ argc > 2 ? argv[2] : "/weather" };
+
+    auto ring{ shm_ring::open(ring_name) };
+
+    constexpr auto kMaxUpdatesToProcess{ 100U };
+    double total_temperature{ 0.0 };
+    auto updates_num{ 0U };
+    std::uint64_t lost_num{ 0 };
+    auto idle_num{ 0U };
+    while (updates_num < kMaxUpdatesToProcess) {
+        //  Take the matching temperatures out of a frame, which count once the frame proves intact
+        double frame_temperature{ 0.0 };
+        auto frame_updates_num{ 0U };
+        const auto status{ ring.read([&](const unsigned char* data, std::size_t size) {
+            for_each_record(data, size, [&](const weather_record& record) {
+                if (zipcode_matches(record.zipcode, zipcode_filter)) {
+                    frame_temperature += record.temperature;
+                    ++frame_updates_num;
+                }
+            });
+        }, lost_num) };
+
+        if (status == shm_ring::read_status::empty) {
+            //  Spin for a while before backing off to sleeping
+            if (++idle_num > 1000) {
+                std::this_thread::sleep_for(std::chrono::microseconds{ 100 });
+            }
+            continue;
+        }
+        idle_num = 0;
+
+        if (status == shm_ring::read_status::read) {
+            total_temperature += frame_temperature;
+            updates_num += frame_updates_num;
+        }
+    }
+
+    const auto average_temperature{ updates_num > 0 ? total_temperature / updates_num : 0.0 };
+    std::cout << "Average temperature at " << zipcode_filter << " is " << average_temperature
+        << ", " << lost_num << " frames have been overrun\n";
+
+    return 0;
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <zmq.hpp>
+
+//  Bridges between the thread-safe queues of a process and the sockets leading out of it.
+//  Stages of a process pass objects through a queue by move, and an object turns into
+//  a message only as it leaves the process, which is what a codec of its type tells how to do:
+//
+//  template <>
+//  struct message_codec<T> {
+//      static zmq::message_t to_message(T&& value);
+//      static T from_message(zmq::message_t&& message);
+//  };
+template <typename T>
+struct message_codec;
+
+//  Messages cross as they are, both ways
+template <>
+struct message_codec<zmq::message_t> {
+    static zmq::message_t to_message(zmq::message_t&& message) {
+        return std::move(message);
+    }
+
+    static zmq::message_t from_message(zmq::message_t&& message) {
+        return std::move(message);
+    }
+};
+
+//  Containers owning a contiguous storage of bytes, e.g. strings and vectors of chars,
+//  views are trivially copyable and own nothing to hand over
+template <typename T>
+concept byte_container = !std::is_trivially_copyable_v<T> && std::is_move_constructible_v<T> &&
+    sizeof(typename T::value_type) == 1 && std::is_trivially_copyable_v<typename T::value_type> &&
+    std::constructible_from<T, const typename T::value_type*, const typename T::value_type*> &&
+    requires(T& bytes) {
+        { bytes.data() } -> std::convertible_to<const void*>;
+        { bytes.size() } -> std::convertible_to<std::size_t>;
+    };
+
+//  A byte container lends its storage to a message rather than being copied into it:
+//  the container moves to the heap, and the message releases it once ZeroMQ is done with the bytes,
+//  which may happen on an I/O thread of the context. Receiving copies the bytes out,
+//  since a container can't adopt a storage of ZeroMQ, message_codec<zmq::message_t> doesn't
+template <byte_container T>
+struct message_codec<T> {
+    static zmq::message_t to_message(T&& bytes) {
+        if (bytes.size() == 0) {
+            return zmq::message_t{};
+        }
+        auto owner{ std::make_unique<T>(std::move(bytes)) };
+        zmq::message_t message{ static_cast<void*>(owner->data()), owner->size(), &release, owner.get() };
+        owner.release();
+        return message;
+    }
+
+    static T from_message(zmq::message_t&& message) {
+        const auto* data{ static_cast<const typename T::value_type*>(message.data()) };
+        return T(data, data + message.size());
+    }
+
+private:
+    static void release(void*, void* owner) {
+        delete static_cast<T*>(owner);
+    }
+};
+
+//  Take up to a number of elements off a queue, waiting for at least one of them.
+//  Queues without bulk pops, like the SPSC ring, are drained an element at a time
+template <typename T, typename Queue>
+std::size_t drain_queue(Queue& queue, std::vector<T>& batch, std::size_t max_count) {
+    if constexpr (requires { queue.wait_and_pop_bulk(std::back_inserter(batch), max_count); }) {
+        return static_cast<std::size_t>(queue.wait_and_pop_bulk(std::back_inserter(batch), max_count));
+    } else {
+        T value{};
+        if (!queue.wait_and_pop(value)) {
+            return 0;
+        }
+        batch.push_back(std::move(value));
+        while (batch.size() < max_count && queue.try_pop(value)) {
+            batch.push_back(std::move(value));
+        }
+        return batch.size();
+    }
+}
+
+//  Move a batch of elements onto a queue, under a single lock where the queue supports it
+template <typename T, typename Queue>
+void fill_queue(Queue& queue, std::vector<T>& batch) {
+    if constexpr (requires { queue.push_range(std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end())); }) {
+        queue.push_range(std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+    } else {
+        for (auto& value : batch) {
+            queue.push(std::move(value));
+        }
+    }
+}
+
+//  Whether a failure of ZeroMQ is the context being shut down, which is how bridges are stopped
+inline bool terminated(const zmq::error_t& error) {
+    return error.num() == ETERM;
+}
+
+//  Send elements of a queue out of a socket, a batch of whatever is at hand at a time,
+//  up to a number of elements, as a single multipart message of a part per element.
+//  A batch costs a single pop of the queue and a single wakeup of the peer.
+//  Tell the number of the elements sent once the queue is closed and drained,
+//  or the context of the socket is shut down
+template <typename T, typename Queue, typename Codec = message_codec<T>>
+std::uint64_t queue_to_socket(Queue& queue, zmq::socket_t& socket, std::size_t batch_size) {
+    std::vector<T> batch{};
+    batch.reserve(batch_size);
+    std::uint64_t sent_num{ 0 };
+    try {
+        while (true) {
+            batch.clear();
+            const auto count{ drain_queue(queue, batch, batch_size) };
+            if (count == 0) {
+                break;
+            }
+            for (std::size_t e{ 0 }; e < count; ++e) {
+                auto part{ Codec::to_message(std::move(batch[e])) };
+                socket.send(part, e + 1 < count ? zmq::send_flags::sndmore : zmq::send_flags::none);
+            }
+            sent_num += count;
+        }
+    } catch (const zmq::error_t& error) {
+        if (!terminated(error)) {
+            throw;
+        }
+    }
+    return sent_num;
+}
+
+//  Receive multipart messages of a socket, as sent by queue_to_socket, and push the elements
+//  of every one of them onto a queue at once. Tell the number of the elements received
+//  once the context of the socket is shut down, and close the queue then, if it can be closed,
+//  so that its consumers drain it and stop
+template <typename T, typename Queue, typename Codec = message_codec<T>>
+std::uint64_t socket_to_queue(zmq::socket_t& socket, Queue& queue) {
+    std::vector<T> batch{};
+    std::uint64_t received_num{ 0 };
+    try {
+        while (true) {
+            batch.clear();
+            auto more{ true };
+            while (more) {
+                zmq::message_t part{};
+                const auto status{ socket.recv(part) };
+                more = part.more();
+                batch.push_back(Codec::from_message(std::move(part)));
+            }
+            fill_queue(queue, batch);
+            received_num += batch.size();
+        }
+    } catch (const zmq::error_t& error) {
+        if (!terminated(error)) {
+            throw;
+        }
+    }
+    if constexpr (requires { queue.close(); }) {
+        queue.close();
+    }
+    return received_num;
+}
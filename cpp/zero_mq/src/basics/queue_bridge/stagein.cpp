@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <zmq.hpp>
+
+#include "BluntQueue.hpp"
+#include "queue_bridge.hpp"
+
+//  Set by an interrupt, which is the only way a downstream stage stops
+static volatile std::sig_atomic_t interrupted{ 0 };
+
+static void interrupt(int) {
+    interrupted = 1;
+}
+
+//  Shut the context down once interrupted, which is not to be done right within a signal handler.
+//  That fails the blocking receive of the bridge, which closes the queue for consumers to finish then
+void watch(zmq::context_t& context) {
+    while (interrupted == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 100 });
+    }
+    context.shutdown();
+}
+
+//  Tell the throughput once a second, so that the console stays off the pipeline
+void report(const std::atomic<std::uint64_t>& consumed, const std::atomic<std::uint64_t>& bytes, const std::atomic<bool>& stopping) {
+    auto last{ consumed.load(std::memory_order_relaxed) };
+    auto last_bytes{ bytes.load(std::memory_order_relaxed) };
+    while (!stopping.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_for(std::chrono::seconds{ 1 });
+        const auto now{ consumed.load(std::memory_order_relaxed) };
+        const auto now_bytes{ bytes.load(std::memory_order_relaxed) };
+        std::cout << "Consumed " << now - last << " messages, " << (now_bytes - last_bytes) / 1e6
+            << " MB per second\n" << std::flush;
+        last = now;
+        last_bytes = now_bytes;
+    }
+}
+
+//  Usage: Downstream [number of consumers] [batch size]
+//
+//  A receiving stage bridges a PULL socket to a queue, and consuming stages take strings
+//  off the queue by move, a batch at a time. An interrupt stops the stages in turn
+int main(int argc, char* argv[]) {
+    const auto consumers_num{ std::max(argc > 1 ? std::stoi(argv[1]) : 1, 1) };
+    const auto batch_size{ std::max<std::size_t>(argc > 2 ? std::stoull(argv[2]) : 64, 1) };
+
+    zmq::context_t context{};
+    zmq::socket_t receiver{ context, ZMQ_PULL };
+    receiver.connect("tcp://localhost:5560");
+
+    std::atomic<std::uint64_t> consumed{ 0 };
+    std::atomic<std::uint64_t> bytes{ 0 };
+    std::atomic<bool> stopping{ false };
+    std::thread reporter{ report, std::cref(consumed), std::cref(bytes), std::cref(stopping) };
+
+    std::signal(SIGINT, interrupt);
+    std::signal(SIGTERM, interrupt);
+    std::thread watcher{ watch, std::ref(context) };
+
+    //  A bounded queue stops receiving once consumers fall behind, so that the sender is held back
+    BluntQueue<std::string> stage{ QueueCapacity{ 16 * batch_size * consumers_num } };
+    std::vector<std::thread> consumers{};
+    for (auto c{ 0 }; c < consumers_num; ++c) {
+        consumers.emplace_back([&stage, &consumed, &bytes, batch_size]() {
+            std::vector<std::string> batch{};
+            while (true) {
+                batch.clear();
+                if (stage.wait_and_pop_bulk(std::back_inserter(batch), batch_size) == 0) {
+                    break;
+                }
+                std::uint64_t size{ 0 };
+                for (const auto& payload : batch) {
+                    size += payload.size();
+                }
+                consumed.fetch_add(batch.size(), std::memory_order_relaxed);
+                bytes.fetch_add(size, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    //  Runs till the context is shut down, which closes the queue for consumers to finish
+    const auto received_num{ socket_to_queue<std::string>(receiver, stage) };
+
+    for (auto& consumer : consumers) {
+        consumer.join();
+    }
+    watcher.join();
+    stopping.store(true, std::memory_order_relaxed);
+    reporter.join();
+
+    std::cout << "Received " << received_num << " messages, consumed " << consumed.load() << std::endl;
+
+    return 0;
+}
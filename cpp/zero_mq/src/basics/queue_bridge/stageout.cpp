@@ -0,0 +1,46 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <zmq.hpp>
+
+#include "BluntQueue.hpp"
+#include "queue_bridge.hpp"
+
+//  Usage: Upstream [number of messages] [message size] [batch size]
+//
+//  A producing stage hands strings over to a sending stage through a queue by move,
+//  and the sending stage drains the queue into a PUSH socket in batches. A string leaves
+//  the process within a message, which borrows its storage rather than copying it
+int main(int argc, char* argv[]) {
+    const auto messages_num{ argc > 1 ? std::stoull(argv[1]) : 1000000ULL };
+    const auto message_size{ argc > 2 ? std::stoull(argv[2]) : 1024ULL };
+    const auto batch_size{ std::max<std::size_t>(argc > 3 ? std::stoull(argv[3]) : 64, 1) };
+
+    zmq::context_t context{};
+    zmq::socket_t sender{ context, ZMQ_PUSH };
+    sender.bind("tcp://*:5560");
+
+    //  A bounded queue holds the producer back once the socket falls behind
+    BluntQueue<std::string> stage{ QueueCapacity{ 16 * batch_size } };
+    std::thread producer{ [&stage, messages_num, message_size]() {
+        for (std::uint64_t m{ 0 }; m < messages_num; ++m) {
+            std::string payload(message_size, static_cast<char>('a' + m % 26));
+            stage.push(std::move(payload));
+        }
+        stage.close();
+    } };
+
+    const auto start{ std::chrono::steady_clock::now() };
+    const auto sent_num{ queue_to_socket<std::string>(stage, sender, batch_size) };
+    const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+    producer.join();
+
+    std::cout << "Sent " << sent_num << " messages of " << message_size << " bytes in " << elapsed.count()
+        << " s, " << sent_num / elapsed.count() << " messages per second" << std::endl;
+
+    return 0;
+}